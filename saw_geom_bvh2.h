@@ -0,0 +1,1069 @@
+// saw_geom_bvh2.h - Spatial ordering and bounding volume hierarchies for 2d primitives
+//                  - Morton (Z-order) keys and parallel radix sort
+//                  - Binned SAH bounding volume hierarchy with 2 or 4 wide nodes
+//                  - 16-bit quantized nodes and cache-oblivious node layout
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.06 - 10/19/26 - Bvh2QueryNearest takes the distance callback by value
+// - v1.05 - 10/19/26 - Added Bvh2QueryNearest, best-first nearest primitive query
+// - v1.04 - 10/19/26 - Added Bvh2LayoutVeb, van Emde Boas node order for large static hierarchies
+// - v1.03 - 10/19/26 - Added Bvh2Q, hierarchies with child bounds quantized to 16 bits
+// - v1.02 - 10/19/26 - Added Bvh2View for hierarchies in memory not owned by a Bvh2 (e.g. a mapped file)
+// - v1.01 - 10/19/26 - Added Bvh2 with parallel, deterministic binned SAH build and Bvh2QueryAabb
+// - v1.00 - 10/19/26 - Initial release: Morton keys and parallel radix sort
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Builds on saw_geom_cd2.h, and saw_job.h for threads
+//
+// - Morton order
+//   - Centers are quantized to 16 bits per axis over a range and bit interleaved into 32-bit keys, so
+//     sorting by key puts spatially close primitives close in memory
+//   - Morton2Sort is a stable LSD radix sort (8 bits per pass, passes where every key shares the digit
+//     are skipped). Histograms and scatters run per block of keys on a JobPool; output does not depend
+//     on the number of threads.
+//   - The result is a permutation: new index i holds what was at old index perm[i]
+//
+// - Bounding volume hierarchy
+//   - Built over an array of Aabb2 (one per primitive, e.g. from CalcAabb2) for static geometry
+//   - Splits are chosen by a binned surface area heuristic (in 2d: half perimeter), 16 bins per axis
+//   - Large nodes near the top are split one at a time with binning spread over the JobPool; nodes
+//     under BVH2_SUBTREE_SIZE primitives are then built as independent tasks. Every split decision
+//     only depends on the input, so the tree is bit-identical for any number of threads.
+//   - The binary tree is collapsed into W-wide nodes (Bvh2<2> or Bvh2<4>), opening the child with
+//     the largest perimeter first, and written as a flat depth-first array with the root at 0
+//   - Child bounds are stored as structure-of-arrays, so Bvh2<4> tests all 4 children of a node in
+//     one go with SSE2
+//   - Bvh2QueryNearest finds the primitive nearest a query shape by any squared distance that is never
+//     below the squared gap between the bounds (Dist2Gap from saw_geom_cd2.h). Nodes and primitives wait
+//     in a heap keyed by the gap of their bounds to the query's, so they are opened best first, and the
+//     search stops once the nearest bound left is past the best distance found.
+//
+// - Quantized hierarchy
+//   - Bvh2Quantize turns a Bvh2 into a Bvh2Q of the same shape whose nodes store child bounds as
+//     16-bit integers on a grid spanning the node (origin plus a power of two step per axis).
+//     A Bvh2QNode<4> is 64 bytes, one cache line, against 96 for Bvh2Node<4>.
+//   - Minimums round down and maximums up, checked against the decoder's own float math, so a
+//     decoded box always contains the true one: no overlap is ever missed. The step is a power of
+//     two, so q * step is exact and decoding gives the same floats with or without fused multiply-add.
+//   - Leaves still test the primitives' own boxes with Cd2AA, so Bvh2QueryAabb returns exactly what
+//     it does on the Bvh2, in the same order; the looser boxes only cost a few extra node visits
+//
+// - Cache-oblivious layout
+//   - Depth-first order keeps a node next to its first child, but its other children (and their
+//     subtrees) end up far away, so deep queries on a tree larger than the caches miss at most levels
+//   - Bvh2LayoutVeb reorders the nodes in van Emde Boas order: the top half of the levels of a tree
+//     first, then each subtree below it, recursively. Any subtree of about h levels then spans
+//     O(1) blocks for every block size, so a root to leaf walk touches O(log_B n) cache lines and pages
+//     instead of O(log n). The root stays at 0 and parents stay before their children.
+//   - Only the node array moves; the tree, the indices and the query results (in the same order) are
+//     unchanged. Works on Bvh2 and Bvh2Q; run it after Bvh2Build (or after Bvh2Quantize) for static
+//     geometry. It costs O(n log h) for a tree of h levels, well under the build itself.
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Requires saw_job.h; define SAW_JOB_IMPLEMENTATION in one file
+// - Functionality is in sawg:: namespace
+
+#ifndef _SAW_GEOM_BVH2_INCLUDED
+#define _SAW_GEOM_BVH2_INCLUDED
+
+#include <algorithm>
+#include <vector>
+#include "saw_geom_cd2.h"
+#include "saw_job.h"
+
+namespace sawg {
+
+//-----------------------------------------------------------------------------------------------------------
+// MORTON ORDER
+//-----------------------------------------------------------------------------------------------------------
+
+// Spread the low 16 bits of v to the even bits
+inline unsigned int Morton2Spread(unsigned int v) {
+	v &= 0xffff;
+	v = (v | (v << 8)) & 0x00ff00ff;
+	v = (v | (v << 4)) & 0x0f0f0f0f;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+// Interleave x (even bits) and y (odd bits)
+inline unsigned int Morton2Encode(unsigned int x, unsigned int y) {
+	return Morton2Spread(x) | (Morton2Spread(y) << 1);
+}
+
+// Keys of points cx[i], cy[i], quantized over range
+inline void Morton2CalcKeys(const float *cx, const float *cy, size_t n, const Aabb2 &range, unsigned int *pKeys) {
+	float w = range.maxX - range.minX, h = range.maxY - range.minY;
+	float sx = w > 0 ? 65535.0f / w : 0, sy = h > 0 ? 65535.0f / h : 0;
+	for (size_t i = 0; i < n; i++) {
+		float qx = (cx[i] - range.minX) * sx;
+		float qy = (cy[i] - range.minY) * sy;
+		qx = qx < 0 ? 0 : (qx > 65535.0f ? 65535.0f : qx);
+		qy = qy < 0 ? 0 : (qy > 65535.0f ? 65535.0f : qy);
+		pKeys[i] = Morton2Encode(static_cast<unsigned int>(qx), static_cast<unsigned int>(qy));
+	}
+}
+
+// Keys of the bounds centers of an array of primitives (Point2, Aabb2, Circle2, Obb2, ...)
+// Quantized over the range of those centers.
+template <class T> inline void Morton2CalcKeys(const T *pPrims, size_t n, unsigned int *pKeys) {
+	std::vector<float> cx(n), cy(n);
+	Aabb2 range(1E+37f, 1E+37f, -1E+37f, -1E+37f);
+	for (size_t i = 0; i < n; i++) {
+		Aabb2 a = CalcAabb2(pPrims[i]);
+		cx[i] = (a.minX + a.maxX) * .5f;
+		cy[i] = (a.minY + a.maxY) * .5f;
+		if (cx[i] < range.minX) range.minX = cx[i];
+		if (cy[i] < range.minY) range.minY = cy[i];
+		if (cx[i] > range.maxX) range.maxX = cx[i];
+		if (cy[i] > range.maxY) range.maxY = cy[i];
+	}
+	if (n)
+		Morton2CalcKeys(&cx[0], &cy[0], n, range, pKeys);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+static const size_t MORTON2_SORT_BLOCK = 16384;
+
+// Buffers reused between Morton2Sort calls
+struct Morton2Scratch {
+	std::vector<unsigned int> keys[2];
+	std::vector<unsigned int> perm[2];
+	std::vector<size_t> hist;  // 256 counts per block, then turned into scatter offsets
+};
+
+struct Morton2SortJob {
+	Morton2Scratch *pScratch;
+	int src;
+	int shift;
+	size_t n;
+};
+
+inline void Morton2HistTask(size_t block, int, void *user) {
+	Morton2SortJob *pJob = static_cast<Morton2SortJob *>(user);
+	const unsigned int *keys = &pJob->pScratch->keys[pJob->src][0];
+	size_t *hist = &pJob->pScratch->hist[block * 256];
+	for (int d = 0; d < 256; d++)
+		hist[d] = 0;
+	size_t end = (block + 1) * MORTON2_SORT_BLOCK < pJob->n ? (block + 1) * MORTON2_SORT_BLOCK : pJob->n;
+	for (size_t i = block * MORTON2_SORT_BLOCK; i < end; i++)
+		hist[(keys[i] >> pJob->shift) & 0xff]++;
+}
+
+inline void Morton2ScatterTask(size_t block, int, void *user) {
+	Morton2SortJob *pJob = static_cast<Morton2SortJob *>(user);
+	Morton2Scratch *pScratch = pJob->pScratch;
+	const unsigned int *keys = &pScratch->keys[pJob->src][0];
+	const unsigned int *perm = &pScratch->perm[pJob->src][0];
+	unsigned int *dstKeys = &pScratch->keys[pJob->src ^ 1][0];
+	unsigned int *dstPerm = &pScratch->perm[pJob->src ^ 1][0];
+	size_t *offset = &pScratch->hist[block * 256];
+	size_t end = (block + 1) * MORTON2_SORT_BLOCK < pJob->n ? (block + 1) * MORTON2_SORT_BLOCK : pJob->n;
+	for (size_t i = block * MORTON2_SORT_BLOCK; i < end; i++) {
+		size_t at = offset[(keys[i] >> pJob->shift) & 0xff]++;
+		dstKeys[at] = keys[i];
+		dstPerm[at] = perm[i];
+	}
+}
+
+// Stable sort of keys; writes the permutation to pPerm (n entries). pool may be null.
+inline void Morton2Sort(saw::JobPool *pool, const unsigned int *keys, size_t n, unsigned int *pPerm, Morton2Scratch *pScratch) {
+	if (n == 0)
+		return;
+	Morton2Scratch &s = *pScratch;
+	for (int i = 0; i < 2; i++) {
+		s.keys[i].resize(n);
+		s.perm[i].resize(n);
+	}
+	for (size_t i = 0; i < n; i++) {
+		s.keys[0][i] = keys[i];
+		s.perm[0][i] = static_cast<unsigned int>(i);
+	}
+	size_t numBlocks = (n + MORTON2_SORT_BLOCK - 1) / MORTON2_SORT_BLOCK;
+	s.hist.resize(numBlocks * 256);
+
+	Morton2SortJob job = { pScratch, 0, 0, n };
+	for (int shift = 0; shift < 32; shift += 8) {
+		job.shift = shift;
+		saw::JobPoolFor(pool, numBlocks, Morton2HistTask, &job);
+
+		// Digit totals; skip the pass if every key has the same digit
+		size_t total[256] = { 0 };
+		for (size_t b = 0; b < numBlocks; b++)
+			for (int d = 0; d < 256; d++)
+				total[d] += s.hist[b * 256 + d];
+		bool skip = false;
+		for (int d = 0; d < 256; d++)
+			skip |= total[d] == n;
+		if (skip)
+			continue;
+
+		// Offsets: digit-major, then block order, keeps the sort stable
+		size_t at = 0;
+		for (int d = 0; d < 256; d++) {
+			for (size_t b = 0; b < numBlocks; b++) {
+				size_t count = s.hist[b * 256 + d];
+				s.hist[b * 256 + d] = at;
+				at += count;
+			}
+		}
+		saw::JobPoolFor(pool, numBlocks, Morton2ScatterTask, &job);
+		job.src ^= 1;
+	}
+	for (size_t i = 0; i < n; i++)
+		pPerm[i] = s.perm[job.src][i];
+}
+
+// dst[i] = src[perm[i]]; dst and src must not overlap
+template <class T> inline void Morton2Permute(const T *src, const unsigned int *perm, size_t n, T *dst) {
+	for (size_t i = 0; i < n; i++)
+		dst[i] = src[perm[i]];
+}
+
+// Reorder a vector in place by a permutation
+template <class T> inline void Morton2Permute(std::vector<T> *pVec, const unsigned int *perm, std::vector<T> *pTemp) {
+	pTemp->resize(pVec->size());
+	if (pVec->empty())
+		return;
+	Morton2Permute(&(*pVec)[0], perm, pVec->size(), &(*pTemp)[0]);
+	pVec->swap(*pTemp);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// BOUNDING VOLUME HIERARCHY
+//-----------------------------------------------------------------------------------------------------------
+
+static const unsigned int BVH2_EMPTY = 0xffffffff;
+static const int BVH2_BINS = 16;
+static const int BVH2_MAX_LEAF_SIZE = 64;
+static const size_t BVH2_BIN_BLOCK = 4096;     // Primitives per binning task of a top node
+static const size_t BVH2_SUBTREE_SIZE = 4096;  // Nodes with at most this many primitives are built as one task
+
+// Node with W children, bounds stored per axis so all children are tested together.
+// Unused slots have child BVH2_EMPTY and inverted bounds, so they never overlap anything.
+template <int W> struct Bvh2Node {
+	float minX[W], minY[W], maxX[W], maxY[W];
+	unsigned int child[W];  // Inner child: node index. Leaf child: first entry in Bvh2::indices.
+	unsigned int count[W];  // Leaf child: number of primitives. Inner child: 0.
+};
+
+template <int W> struct Bvh2 {
+	std::vector<Bvh2Node<W> > nodes;    // Root at 0, parents before children; empty if built over no primitives
+	std::vector<unsigned int> indices;  // Primitive indices, each leaf is a contiguous range
+	Aabb2 bounds;
+};
+
+// Read-only hierarchy in memory owned elsewhere
+template <int W> struct Bvh2View {
+	const Bvh2Node<W> *nodes;
+	size_t numNodes;
+	const unsigned int *indices;
+	size_t numIndices;
+	Aabb2 bounds;
+};
+
+template <int W> inline Bvh2View<W> Bvh2GetView(const Bvh2<W> &bvh) {
+	Bvh2View<W> v = { bvh.nodes.empty() ? 0 : &bvh.nodes[0], bvh.nodes.size(),
+		bvh.indices.empty() ? 0 : &bvh.indices[0], bvh.indices.size(), bvh.bounds };
+	return v;
+}
+
+inline Aabb2 Bvh2EmptyBox() { return Aabb2(1E+37f, 1E+37f, -1E+37f, -1E+37f); }
+
+inline void Bvh2Grow(Aabb2 *pBox, const Aabb2 &a) {
+	if (a.minX < pBox->minX) pBox->minX = a.minX;
+	if (a.minY < pBox->minY) pBox->minY = a.minY;
+	if (a.maxX > pBox->maxX) pBox->maxX = a.maxX;
+	if (a.maxY > pBox->maxY) pBox->maxY = a.maxY;
+}
+
+// Half perimeter, the 2d stand-in for surface area
+inline float Bvh2Cost(const Aabb2 &a) {
+	return a.maxX < a.minX ? 0 : (a.maxX - a.minX) + (a.maxY - a.minY);
+}
+
+struct Bvh2BuildNode {
+	Aabb2 box;
+	Aabb2 centers;                 // Bounds of the primitive centers, for binning
+	unsigned int first, count;     // Range in Bvh2BuildScratch::order
+	unsigned int childTree[2];     // BVH2_EMPTY for a leaf
+	unsigned int childNode[2];
+};
+
+struct Bvh2Bin {
+	Aabb2 box;
+	Aabb2 centers;
+	unsigned int count;
+};
+
+// Buffers reused between Bvh2Build calls
+struct Bvh2BuildScratch {
+	std::vector<float> center[2];
+	std::vector<unsigned int> order;
+	std::vector<std::vector<Bvh2BuildNode> > trees;  // 0 holds the top nodes, then one tree per subtree task
+	std::vector<Bvh2Bin> blockBins;
+	std::vector<unsigned int> stack;
+};
+
+struct Bvh2BuildJob {
+	const Aabb2 *boxes;
+	Bvh2BuildScratch *pScratch;
+	int maxLeafSize;
+	Bvh2BuildNode node;  // Top node being binned
+};
+
+inline int Bvh2BinIndex(float c, float lo, float scale) {
+	float f = (c - lo) * scale;
+	return f <= 0 ? 0 : (f >= BVH2_BINS - 1 ? BVH2_BINS - 1 : static_cast<int>(f));
+}
+
+inline float Bvh2BinScale(float lo, float hi) {
+	return hi - lo > 1E-20f ? BVH2_BINS / (hi - lo) : 0;
+}
+
+struct Bvh2SplitPred {
+	const float *center;
+	float lo, scale;
+	int bin;
+	bool operator()(unsigned int idx) const { return Bvh2BinIndex(center[idx], lo, scale) <= bin; }
+};
+
+// Bin primitives order[first, end) of a node on both axes; bins has 2 * BVH2_BINS entries
+inline void Bvh2BinRange(const Bvh2BuildJob &job, const Bvh2BuildNode &node, size_t first, size_t end, Bvh2Bin *bins) {
+	const Bvh2BuildScratch &s = *job.pScratch;
+	float lo[2] = { node.centers.minX, node.centers.minY };
+	float scale[2] = { Bvh2BinScale(node.centers.minX, node.centers.maxX), Bvh2BinScale(node.centers.minY, node.centers.maxY) };
+	for (int i = 0; i < 2 * BVH2_BINS; i++) {
+		bins[i].box = Bvh2EmptyBox();
+		bins[i].centers = Bvh2EmptyBox();
+		bins[i].count = 0;
+	}
+	for (size_t i = first; i < end; i++) {
+		unsigned int idx = s.order[i];
+		float cx = s.center[0][idx], cy = s.center[1][idx];
+		Aabb2 c(cx, cy, cx, cy);
+		for (int axis = 0; axis < 2; axis++) {
+			Bvh2Bin &bin = bins[axis * BVH2_BINS + Bvh2BinIndex(s.center[axis][idx], lo[axis], scale[axis])];
+			Bvh2Grow(&bin.box, job.boxes[idx]);
+			Bvh2Grow(&bin.centers, c);
+			bin.count++;
+		}
+	}
+}
+
+inline void Bvh2BinTask(size_t block, int, void *user) {
+	Bvh2BuildJob *pJob = static_cast<Bvh2BuildJob *>(user);
+	size_t first = pJob->node.first + block * BVH2_BIN_BLOCK;
+	size_t end = pJob->node.first + pJob->node.count;
+	if (end > first + BVH2_BIN_BLOCK)
+		end = first + BVH2_BIN_BLOCK;
+	Bvh2BinRange(*pJob, pJob->node, first, end, &pJob->pScratch->blockBins[block * 2 * BVH2_BINS]);
+}
+
+// Bounds of the boxes and centers of order[first, first + count)
+inline void Bvh2CalcNodeBounds(const Bvh2BuildJob &job, Bvh2BuildNode *pNode) {
+	const Bvh2BuildScratch &s = *job.pScratch;
+	pNode->box = Bvh2EmptyBox();
+	pNode->centers = Bvh2EmptyBox();
+	for (size_t i = pNode->first; i < pNode->first + pNode->count; i++) {
+		unsigned int idx = s.order[i];
+		Bvh2Grow(&pNode->box, job.boxes[idx]);
+		Bvh2Grow(&pNode->centers, Aabb2(s.center[0][idx], s.center[1][idx], s.center[0][idx], s.center[1][idx]));
+	}
+}
+
+// Choose the best split from the bins and partition the node's primitives.
+// Returns false if the node should be a leaf.
+inline bool Bvh2SplitNode(const Bvh2BuildJob &job, const Bvh2BuildNode &node, const Bvh2Bin *bins,
+	Bvh2BuildNode *pLeft, Bvh2BuildNode *pRight) {
+	if (node.count <= 1)
+		return false;
+	int bestAxis = -1, bestBin = 0;
+	float bestCost = 0;
+	for (int axis = 0; axis < 2; axis++) {
+		const Bvh2Bin *b = bins + axis * BVH2_BINS;
+		float rightCost[BVH2_BINS];
+		Aabb2 box = Bvh2EmptyBox();
+		unsigned int count = 0;
+		for (int i = BVH2_BINS - 1; i > 0; i--) {
+			Bvh2Grow(&box, b[i].box);
+			count += b[i].count;
+			rightCost[i] = Bvh2Cost(box) * count;
+		}
+		box = Bvh2EmptyBox();
+		count = 0;
+		for (int i = 0; i < BVH2_BINS - 1; i++) {
+			Bvh2Grow(&box, b[i].box);
+			count += b[i].count;
+			if (count == 0 || count == node.count)
+				continue;
+			float cost = Bvh2Cost(box) * count + rightCost[i + 1];
+			if (bestAxis < 0 || cost < bestCost) {
+				bestAxis = axis;
+				bestBin = i;
+				bestCost = cost;
+			}
+		}
+	}
+
+	// Leaf if small enough and splitting (one traversal step, unit cost per primitive) does not pay off
+	if (static_cast<int>(node.count) <= job.maxLeafSize && (bestAxis < 0 || bestCost >= Bvh2Cost(node.box) * (node.count - 1)))
+		return false;
+
+	const Bvh2BuildScratch &s = *job.pScratch;
+	unsigned int *order = &job.pScratch->order[0];
+	*pLeft = node;
+	*pRight = node;
+	if (bestAxis < 0) {
+		// Every center in the same spot: split the range in half
+		pLeft->count = node.count / 2;
+		pRight->first = node.first + pLeft->count;
+		pRight->count = node.count - pLeft->count;
+		Bvh2CalcNodeBounds(job, pLeft);
+		Bvh2CalcNodeBounds(job, pRight);
+	} else {
+		Bvh2SplitPred pred;
+		pred.center = &s.center[bestAxis][0];
+		pred.lo = bestAxis ? node.centers.minY : node.centers.minX;
+		pred.scale = bestAxis ? Bvh2BinScale(node.centers.minY, node.centers.maxY) : Bvh2BinScale(node.centers.minX, node.centers.maxX);
+		pred.bin = bestBin;
+		unsigned int *mid = std::partition(order + node.first, order + node.first + node.count, pred);
+		pLeft->count = static_cast<unsigned int>(mid - (order + node.first));
+		pRight->first = node.first + pLeft->count;
+		pRight->count = node.count - pLeft->count;
+		const Bvh2Bin *b = bins + bestAxis * BVH2_BINS;
+		pLeft->box = pLeft->centers = pRight->box = pRight->centers = Bvh2EmptyBox();
+		for (int i = 0; i < BVH2_BINS; i++) {
+			Bvh2BuildNode *pSide = i <= bestBin ? pLeft : pRight;
+			Bvh2Grow(&pSide->box, b[i].box);
+			Bvh2Grow(&pSide->centers, b[i].centers);
+		}
+	}
+	pLeft->childTree[0] = pLeft->childTree[1] = pRight->childTree[0] = pRight->childTree[1] = BVH2_EMPTY;
+	return true;
+}
+
+// Build one subtree task serially into trees[1 + task]
+inline void Bvh2SubtreeTask(size_t task, int, void *user) {
+	Bvh2BuildJob *pJob = static_cast<Bvh2BuildJob *>(user);
+	std::vector<Bvh2BuildNode> &tree = pJob->pScratch->trees[1 + task];
+	Bvh2Bin bins[2 * BVH2_BINS];
+	tree.resize(1);
+	for (size_t i = 0; i < tree.size(); i++) {
+		Bvh2BuildNode node = tree[i];
+		Bvh2BinRange(*pJob, node, node.first, node.first + node.count, bins);
+		Bvh2BuildNode children[2];
+		if (!Bvh2SplitNode(*pJob, node, bins, &children[0], &children[1]))
+			continue;
+		for (int k = 0; k < 2; k++) {
+			tree[i].childTree[k] = static_cast<unsigned int>(1 + task);
+			tree[i].childNode[k] = static_cast<unsigned int>(tree.size());
+			tree.push_back(children[k]);
+		}
+	}
+}
+
+// Collapse the binary build trees into W-wide nodes, depth first
+template <int W> inline void Bvh2Flatten(Bvh2BuildScratch *pScratch, unsigned int rootTree, Bvh2<W> *pOut) {
+	Bvh2BuildScratch &s = *pScratch;
+	s.stack.clear();
+	s.stack.push_back(rootTree);
+	s.stack.push_back(0);
+	s.stack.push_back(BVH2_EMPTY);  // Parent node
+	s.stack.push_back(0);           // Slot in parent
+	while (!s.stack.empty()) {
+		unsigned int slot = s.stack.back(); s.stack.pop_back();
+		unsigned int parent = s.stack.back(); s.stack.pop_back();
+		unsigned int nodeIdx = s.stack.back(); s.stack.pop_back();
+		unsigned int treeIdx = s.stack.back(); s.stack.pop_back();
+
+		// Open the inner child with the largest perimeter until there are W children
+		unsigned int trees[W], nodes[W];
+		int num = 1;
+		trees[0] = treeIdx;
+		nodes[0] = nodeIdx;
+		while (num < W) {
+			int open = -1;
+			float openCost = 0;
+			for (int k = 0; k < num; k++) {
+				const Bvh2BuildNode &n = s.trees[trees[k]][nodes[k]];
+				if (n.childTree[0] != BVH2_EMPTY && (open < 0 || Bvh2Cost(n.box) > openCost)) {
+					open = k;
+					openCost = Bvh2Cost(n.box);
+				}
+			}
+			if (open < 0)
+				break;
+			const Bvh2BuildNode &n = s.trees[trees[open]][nodes[open]];
+			for (int k = num; k > open + 1; k--) {
+				trees[k] = trees[k - 1];
+				nodes[k] = nodes[k - 1];
+			}
+			trees[open + 1] = n.childTree[1];
+			nodes[open + 1] = n.childNode[1];
+			trees[open] = n.childTree[0];
+			nodes[open] = n.childNode[0];
+			num++;
+		}
+
+		unsigned int outIdx = static_cast<unsigned int>(pOut->nodes.size());
+		pOut->nodes.push_back(Bvh2Node<W>());
+		if (parent != BVH2_EMPTY)
+			pOut->nodes[parent].child[slot] = outIdx;
+		Bvh2Node<W> &out = pOut->nodes[outIdx];
+		for (int k = 0; k < W; k++) {
+			if (k >= num) {
+				out.minX[k] = out.minY[k] = 1E+37f;
+				out.maxX[k] = out.maxY[k] = -1E+37f;
+				out.child[k] = BVH2_EMPTY;
+				out.count[k] = 0;
+				continue;
+			}
+			const Bvh2BuildNode &n = s.trees[trees[k]][nodes[k]];
+			out.minX[k] = n.box.minX;
+			out.minY[k] = n.box.minY;
+			out.maxX[k] = n.box.maxX;
+			out.maxY[k] = n.box.maxY;
+			if (n.childTree[0] == BVH2_EMPTY) {
+				out.child[k] = n.first;
+				out.count[k] = n.count;
+			} else {
+				out.child[k] = BVH2_EMPTY;  // Patched when the child node is written
+				out.count[k] = 0;
+			}
+		}
+
+		// Push inner children in reverse so the first is written next
+		for (int k = num - 1; k >= 0; k--) {
+			if (out.count[k] != 0)
+				continue;
+			s.stack.push_back(trees[k]);
+			s.stack.push_back(nodes[k]);
+			s.stack.push_back(outIdx);
+			s.stack.push_back(static_cast<unsigned int>(k));
+		}
+	}
+}
+
+// Build a W-wide (2 or 4) hierarchy over boxes[0..n-1]. pool may be null.
+// Output is identical for any pool and number of threads.
+template <int W> inline void Bvh2Build(saw::JobPool *pool, const Aabb2 *boxes, size_t n, Bvh2<W> *pOut,
+	Bvh2BuildScratch *pScratch, int maxLeafSize = 4) {
+	Bvh2BuildScratch &s = *pScratch;
+	pOut->nodes.clear();
+	pOut->indices.clear();
+	pOut->bounds = Bvh2EmptyBox();
+	if (n == 0)
+		return;
+
+	Bvh2BuildJob job;
+	job.boxes = boxes;
+	job.pScratch = pScratch;
+	job.maxLeafSize = maxLeafSize < 1 ? 1 : (maxLeafSize > BVH2_MAX_LEAF_SIZE ? BVH2_MAX_LEAF_SIZE : maxLeafSize);
+	s.center[0].resize(n);
+	s.center[1].resize(n);
+	s.order.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		s.center[0][i] = (boxes[i].minX + boxes[i].maxX) * .5f;
+		s.center[1][i] = (boxes[i].minY + boxes[i].maxY) * .5f;
+		s.order[i] = static_cast<unsigned int>(i);
+	}
+	Bvh2BuildNode root;
+	root.first = 0;
+	root.count = static_cast<unsigned int>(n);
+	root.childTree[0] = root.childTree[1] = BVH2_EMPTY;
+	root.childNode[0] = root.childNode[1] = 0;
+	Bvh2CalcNodeBounds(job, &root);
+	pOut->bounds = root.box;
+
+	// Split the top nodes one at a time, binning in parallel; small nodes become subtree tasks
+	s.trees.resize(1);
+	std::vector<Bvh2BuildNode> &top = s.trees[0];
+	std::vector<Bvh2BuildNode> tasks;
+	top.clear();
+	unsigned int rootTree = n > BVH2_SUBTREE_SIZE ? 0 : 1;
+	if (rootTree == 0)
+		top.push_back(root);
+	else
+		tasks.push_back(root);
+	for (size_t i = 0; i < top.size(); i++) {
+		job.node = top[i];
+		size_t numBlocks = (job.node.count + BVH2_BIN_BLOCK - 1) / BVH2_BIN_BLOCK;
+		s.blockBins.resize(numBlocks * 2 * BVH2_BINS);
+		saw::JobPoolFor(pool, numBlocks, Bvh2BinTask, &job);
+		Bvh2Bin bins[2 * BVH2_BINS];
+		for (int k = 0; k < 2 * BVH2_BINS; k++) {
+			bins[k] = s.blockBins[k];
+			for (size_t b = 1; b < numBlocks; b++) {
+				const Bvh2Bin &other = s.blockBins[b * 2 * BVH2_BINS + k];
+				Bvh2Grow(&bins[k].box, other.box);
+				Bvh2Grow(&bins[k].centers, other.centers);
+				bins[k].count += other.count;
+			}
+		}
+		Bvh2BuildNode children[2];
+		Bvh2SplitNode(job, job.node, bins, &children[0], &children[1]);
+		for (int k = 0; k < 2; k++) {
+			if (children[k].count > BVH2_SUBTREE_SIZE) {
+				top[i].childTree[k] = 0;
+				top[i].childNode[k] = static_cast<unsigned int>(top.size());
+				top.push_back(children[k]);
+			} else {
+				top[i].childTree[k] = static_cast<unsigned int>(1 + tasks.size());
+				top[i].childNode[k] = 0;
+				tasks.push_back(children[k]);
+			}
+		}
+	}
+	s.trees.resize(1 + tasks.size());  // top is not used past here
+	for (size_t i = 0; i < tasks.size(); i++) {
+		s.trees[1 + i].clear();
+		s.trees[1 + i].push_back(tasks[i]);
+	}
+	saw::JobPoolFor(pool, tasks.size(), Bvh2SubtreeTask, &job);
+
+	Bvh2Flatten(pScratch, rootTree, pOut);
+	pOut->indices = s.order;
+}
+
+// Bitmask of the children of node whose bounds overlap box
+template <int W> inline int Bvh2NodeOverlap(const Bvh2Node<W> &node, const Aabb2 &box) {
+	int mask = 0;
+	for (int k = 0; k < W; k++)
+		if (node.minX[k] <= box.maxX && node.maxX[k] >= box.minX && node.minY[k] <= box.maxY && node.maxY[k] >= box.minY)
+			mask |= 1 << k;
+	return mask;
+}
+
+#ifdef SAW_GEOM_SSE2
+template <> inline int Bvh2NodeOverlap<4>(const Bvh2Node<4> &node, const Aabb2 &box) {
+	__m128 in = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node.minX), _mm_set1_ps(box.maxX)),
+		_mm_cmpge_ps(_mm_loadu_ps(node.maxX), _mm_set1_ps(box.minX)));
+	in = _mm_and_ps(in, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node.minY), _mm_set1_ps(box.maxY)),
+		_mm_cmpge_ps(_mm_loadu_ps(node.maxY), _mm_set1_ps(box.minY))));
+	return _mm_movemask_ps(in);
+}
+#endif
+
+// Indices of the primitives whose bounds overlap box, in depth-first order.
+// boxes are the bounds the hierarchy was built from.
+template <int W> inline void Bvh2QueryAabb(const Bvh2View<W> &bvh, const Aabb2 *boxes, const Aabb2 &box,
+	std::vector<unsigned int> *pOut) {
+	pOut->clear();
+	if (bvh.numNodes == 0)
+		return;
+	unsigned int stackBuf[64];
+	std::vector<unsigned int> stackBig;
+	unsigned int *stack = stackBuf;
+	size_t top = 0, capacity = 64;
+	stack[top++] = 0;
+	while (top) {
+		const Bvh2Node<W> &node = bvh.nodes[stack[--top]];
+		int mask = Bvh2NodeOverlap(node, box);
+		for (int k = 0; k < W; k++) {
+			if ((mask & (1 << k)) && node.count[k]) {
+				for (unsigned int i = node.child[k]; i < node.child[k] + node.count[k]; i++)
+					if (Cd2AA(boxes[bvh.indices[i]], box))
+						pOut->push_back(bvh.indices[i]);
+			}
+		}
+		for (int k = W - 1; k >= 0; k--) {
+			if (!(mask & (1 << k)) || node.count[k])
+				continue;
+			if (top == capacity) {
+				if (stack == stackBuf)
+					stackBig.assign(stackBuf, stackBuf + top);
+				capacity *= 2;
+				stackBig.resize(capacity);
+				stack = &stackBig[0];
+			}
+			stack[top++] = node.child[k];
+		}
+	}
+}
+
+template <int W> inline void Bvh2QueryAabb(const Bvh2<W> &bvh, const Aabb2 *boxes, const Aabb2 &box,
+	std::vector<unsigned int> *pOut) {
+	Bvh2QueryAabb(Bvh2GetView(bvh), boxes, box, pOut);
+}
+
+// Squared gap between two boxes, 0 if they overlap
+inline float Bvh2BoxGap2(const Aabb2 &a, float minX, float minY, float maxX, float maxY) {
+	float dx = minX - a.maxX > a.minX - maxX ? minX - a.maxX : a.minX - maxX;
+	float dy = minY - a.maxY > a.minY - maxY ? minY - a.maxY : a.minY - maxY;
+	dx = dx > 0 ? dx : 0;
+	dy = dy > 0 ? dy : 0;
+	return dx * dx + dy * dy;
+}
+
+// Node (count 0) or primitive (count 1, child is the primitive) waiting in the nearest query heap
+struct Bvh2NearestEntry {
+	float gap2;
+	unsigned int child, count;
+	Bvh2NearestEntry(float gap2, unsigned int child, unsigned int count) : gap2(gap2), child(child), count(count) { }
+	bool operator<(const Bvh2NearestEntry &e) const { return gap2 > e.gap2; }  // Smallest gap on top of std::push_heap
+};
+
+struct Bvh2NearestScratch {
+	std::vector<Bvh2NearestEntry> heap;
+};
+
+// Index of the primitive nearest the query, or BVH2_EMPTY if none is within maxDist2. queryBox bounds the query
+// and boxes are the bounds the hierarchy was built from. dist(i) is the squared distance from the query to
+// primitive i and must not be below the squared gap between queryBox and boxes[i] (as Dist2Gap); it is taken
+// by value, so a lambda or temporary functor can be passed inline. Ties go to the lower index. pDist2 (may be
+// null) gets the distance found.
+template <int W, class F> inline unsigned int Bvh2QueryNearest(const Bvh2View<W> &bvh, const Aabb2 *boxes, const Aabb2 &queryBox,
+	F dist, float maxDist2, float *pDist2, Bvh2NearestScratch *pScratch) {
+	std::vector<Bvh2NearestEntry> &heap = pScratch->heap;
+	heap.clear();
+	float best = maxDist2;
+	unsigned int bestIndex = BVH2_EMPTY;
+	if (bvh.numNodes) {
+		float gap2 = Bvh2BoxGap2(queryBox, bvh.bounds.minX, bvh.bounds.minY, bvh.bounds.maxX, bvh.bounds.maxY);
+		if (gap2 <= best)
+			heap.push_back(Bvh2NearestEntry(gap2, 0, 0));
+	}
+	while (!heap.empty() && heap.front().gap2 <= best) {
+		Bvh2NearestEntry e = heap.front();
+		std::pop_heap(heap.begin(), heap.end());
+		heap.pop_back();
+		if (e.count) {
+			float d = dist(e.child);
+			if (d < best || (d == best && e.child < bestIndex)) {
+				best = d;
+				bestIndex = e.child;
+			}
+			continue;
+		}
+		const Bvh2Node<W> &node = bvh.nodes[e.child];
+		for (int k = 0; k < W; k++) {
+			if (node.child[k] == BVH2_EMPTY)
+				continue;
+			if (node.count[k]) {
+				for (unsigned int i = node.child[k]; i < node.child[k] + node.count[k]; i++) {
+					const Aabb2 &b = boxes[bvh.indices[i]];
+					float gap2 = Bvh2BoxGap2(queryBox, b.minX, b.minY, b.maxX, b.maxY);
+					if (gap2 <= best) {
+						heap.push_back(Bvh2NearestEntry(gap2, bvh.indices[i], 1));
+						std::push_heap(heap.begin(), heap.end());
+					}
+				}
+			}
+			else {
+				float gap2 = Bvh2BoxGap2(queryBox, node.minX[k], node.minY[k], node.maxX[k], node.maxY[k]);
+				if (gap2 <= best) {
+					heap.push_back(Bvh2NearestEntry(gap2, node.child[k], 0));
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+		}
+	}
+	if (pDist2)
+		*pDist2 = best;
+	return bestIndex;
+}
+
+template <int W, class F> inline unsigned int Bvh2QueryNearest(const Bvh2<W> &bvh, const Aabb2 *boxes, const Aabb2 &queryBox,
+	F dist, float maxDist2, float *pDist2, Bvh2NearestScratch *pScratch) {
+	return Bvh2QueryNearest(Bvh2GetView(bvh), boxes, queryBox, dist, maxDist2, pDist2, pScratch);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// QUANTIZED HIERARCHY
+//-----------------------------------------------------------------------------------------------------------
+
+static const int BVH2Q_MAX = 65535;
+static const size_t BVH2Q_GRAIN = 4096;  // Nodes per Bvh2Quantize task
+
+// Node with W children whose bounds are origin + q * 2^exp per axis.
+// Leaf counts fit in a byte (at most BVH2_MAX_LEAF_SIZE); used marks the slots holding a child.
+template <int W> struct Bvh2QNode {
+	float originX, originY;
+	signed char expX, expY;
+	unsigned char used;
+	unsigned char count[W];  // Leaf child: number of primitives. Inner child: 0.
+	unsigned short qMinX[W], qMinY[W], qMaxX[W], qMaxY[W];
+	unsigned int child[W];   // Inner child: node index. Leaf child: first entry in Bvh2Q::indices.
+};
+
+template <int W> struct Bvh2Q {
+	std::vector<Bvh2QNode<W> > nodes;
+	std::vector<unsigned int> indices;
+	Aabb2 bounds;
+};
+
+// 2^e as a float, e in -126..127
+inline float Bvh2QStep(int e) {
+	unsigned int bits = static_cast<unsigned int>(e + 127) << 23;
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+inline float Bvh2QDecode(float origin, float step, unsigned int q) {
+	return origin + static_cast<float>(q) * step;
+}
+
+// Smallest exponent whose grid reaches from lo past hi
+inline int Bvh2QCalcExp(float lo, float hi) {
+	int e = -126;
+	if (hi - lo > 0) {
+		frexp((hi - lo) / BVH2Q_MAX, &e);
+		e = e < -126 ? -126 : (e > 127 ? 127 : e);
+		while (e > -126 && Bvh2QDecode(lo, Bvh2QStep(e - 1), BVH2Q_MAX) >= hi)
+			e--;
+	}
+	while (e < 127 && Bvh2QDecode(lo, Bvh2QStep(e), BVH2Q_MAX) < hi)
+		e++;
+	return e;
+}
+
+// Grid cell at or below v (round down), or at or above v (round up)
+inline unsigned short Bvh2QEncode(float origin, float step, float v, bool up) {
+	float f = (v - origin) / step;
+	int q = f <= 0 ? 0 : (f >= BVH2Q_MAX ? BVH2Q_MAX : static_cast<int>(f));
+	if (up) {
+		while (q < BVH2Q_MAX && Bvh2QDecode(origin, step, q) < v)
+			q++;
+	} else {
+		while (q > 0 && Bvh2QDecode(origin, step, q) > v)
+			q--;
+	}
+	return static_cast<unsigned short>(q);
+}
+
+template <int W> inline void Bvh2QuantizeNode(const Bvh2Node<W> &in, Bvh2QNode<W> *pOut) {
+	Bvh2QNode<W> &out = *pOut;
+	Aabb2 box = Bvh2EmptyBox();
+	out.used = 0;
+	for (int k = 0; k < W; k++) {
+		if (in.minX[k] > in.maxX[k])
+			continue;
+		Bvh2Grow(&box, Aabb2(in.minX[k], in.minY[k], in.maxX[k], in.maxY[k]));
+		out.used |= 1 << k;
+	}
+	if (!out.used)
+		box = Aabb2(0, 0, 0, 0);
+	out.originX = box.minX;
+	out.originY = box.minY;
+	out.expX = static_cast<signed char>(Bvh2QCalcExp(box.minX, box.maxX));
+	out.expY = static_cast<signed char>(Bvh2QCalcExp(box.minY, box.maxY));
+	float stepX = Bvh2QStep(out.expX), stepY = Bvh2QStep(out.expY);
+	for (int k = 0; k < W; k++) {
+		out.child[k] = in.child[k];
+		out.count[k] = static_cast<unsigned char>(in.count[k]);
+		if (!(out.used & (1 << k))) {
+			out.qMinX[k] = out.qMinY[k] = BVH2Q_MAX;
+			out.qMaxX[k] = out.qMaxY[k] = 0;
+			continue;
+		}
+		out.qMinX[k] = Bvh2QEncode(out.originX, stepX, in.minX[k], false);
+		out.qMinY[k] = Bvh2QEncode(out.originY, stepY, in.minY[k], false);
+		out.qMaxX[k] = Bvh2QEncode(out.originX, stepX, in.maxX[k], true);
+		out.qMaxY[k] = Bvh2QEncode(out.originY, stepY, in.maxY[k], true);
+	}
+}
+
+template <int W> struct Bvh2QuantizeJob {
+	const Bvh2Node<W> *in;
+	Bvh2QNode<W> *out;
+	size_t numNodes;
+};
+
+template <int W> inline void Bvh2QuantizeTask(size_t task, int, void *user) {
+	const Bvh2QuantizeJob<W> &job = *static_cast<Bvh2QuantizeJob<W> *>(user);
+	size_t end = (task + 1) * BVH2Q_GRAIN < job.numNodes ? (task + 1) * BVH2Q_GRAIN : job.numNodes;
+	for (size_t i = task * BVH2Q_GRAIN; i < end; i++)
+		Bvh2QuantizeNode(job.in[i], &job.out[i]);
+}
+
+// Quantized copy of a hierarchy (same nodes and indices). pool may be null.
+template <int W> inline void Bvh2Quantize(saw::JobPool *pool, const Bvh2<W> &bvh, Bvh2Q<W> *pOut) {
+	pOut->nodes.resize(bvh.nodes.size());
+	pOut->indices = bvh.indices;
+	pOut->bounds = bvh.bounds;
+	if (bvh.nodes.empty())
+		return;
+	Bvh2QuantizeJob<W> job = { &bvh.nodes[0], &pOut->nodes[0], bvh.nodes.size() };
+	saw::JobPoolFor(pool, (job.numNodes + BVH2Q_GRAIN - 1) / BVH2Q_GRAIN, Bvh2QuantizeTask<W>, &job);
+}
+
+// Child bounds of a node as floats (each contains the original child bounds)
+template <int W> inline Aabb2 Bvh2QGetChildBox(const Bvh2QNode<W> &node, int k) {
+	float stepX = Bvh2QStep(node.expX), stepY = Bvh2QStep(node.expY);
+	return Aabb2(Bvh2QDecode(node.originX, stepX, node.qMinX[k]), Bvh2QDecode(node.originY, stepY, node.qMinY[k]),
+		Bvh2QDecode(node.originX, stepX, node.qMaxX[k]), Bvh2QDecode(node.originY, stepY, node.qMaxY[k]));
+}
+
+// Bitmask of the used children of node whose decoded bounds overlap box
+template <int W> inline int Bvh2QNodeOverlap(const Bvh2QNode<W> &node, const Aabb2 &box) {
+	int mask = 0;
+	for (int k = 0; k < W; k++) {
+		Aabb2 c = Bvh2QGetChildBox(node, k);
+		if (c.minX <= box.maxX && c.maxX >= box.minX && c.minY <= box.maxY && c.maxY >= box.minY)
+			mask |= 1 << k;
+	}
+	return mask & node.used;
+}
+
+#ifdef SAW_GEOM_SSE2
+inline __m128 Bvh2QDecode4(const unsigned short *q, __m128 origin, __m128 step) {
+	__m128i q32 = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(q)), _mm_setzero_si128());
+	return _mm_add_ps(origin, _mm_mul_ps(_mm_cvtepi32_ps(q32), step));
+}
+
+template <> inline int Bvh2QNodeOverlap<4>(const Bvh2QNode<4> &node, const Aabb2 &box) {
+	__m128 ox = _mm_set1_ps(node.originX), oy = _mm_set1_ps(node.originY);
+	__m128 sx = _mm_set1_ps(Bvh2QStep(node.expX)), sy = _mm_set1_ps(Bvh2QStep(node.expY));
+	__m128 in = _mm_and_ps(_mm_cmple_ps(Bvh2QDecode4(node.qMinX, ox, sx), _mm_set1_ps(box.maxX)),
+		_mm_cmpge_ps(Bvh2QDecode4(node.qMaxX, ox, sx), _mm_set1_ps(box.minX)));
+	in = _mm_and_ps(in, _mm_and_ps(_mm_cmple_ps(Bvh2QDecode4(node.qMinY, oy, sy), _mm_set1_ps(box.maxY)),
+		_mm_cmpge_ps(Bvh2QDecode4(node.qMaxY, oy, sy), _mm_set1_ps(box.minY))));
+	return _mm_movemask_ps(in) & node.used;
+}
+#endif
+
+// Indices of the primitives whose bounds overlap box, in depth-first order (as Bvh2QueryAabb on a Bvh2).
+// boxes are the bounds the hierarchy was built from.
+template <int W> inline void Bvh2QueryAabb(const Bvh2Q<W> &bvh, const Aabb2 *boxes, const Aabb2 &box,
+	std::vector<unsigned int> *pOut) {
+	pOut->clear();
+	if (bvh.nodes.empty())
+		return;
+	unsigned int stackBuf[64];
+	std::vector<unsigned int> stackBig;
+	unsigned int *stack = stackBuf;
+	size_t top = 0, capacity = 64;
+	stack[top++] = 0;
+	while (top) {
+		const Bvh2QNode<W> &node = bvh.nodes[stack[--top]];
+		int mask = Bvh2QNodeOverlap(node, box);
+		for (int k = 0; k < W; k++) {
+			if ((mask & (1 << k)) && node.count[k]) {
+				for (unsigned int i = node.child[k]; i < node.child[k] + node.count[k]; i++)
+					if (Cd2AA(boxes[bvh.indices[i]], box))
+						pOut->push_back(bvh.indices[i]);
+			}
+		}
+		for (int k = W - 1; k >= 0; k--) {
+			if (!(mask & (1 << k)) || node.count[k])
+				continue;
+			if (top == capacity) {
+				if (stack == stackBuf)
+					stackBig.assign(stackBuf, stackBuf + top);
+				capacity *= 2;
+				stackBig.resize(capacity);
+				stack = &stackBig[0];
+			}
+			stack[top++] = node.child[k];
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// CACHE-OBLIVIOUS LAYOUT
+//-----------------------------------------------------------------------------------------------------------
+
+template <class Node> inline bool Bvh2IsInner(const Node &node, int k) {
+	return node.count[k] == 0 && node.child[k] != BVH2_EMPTY;
+}
+
+// Levels of nodes in the subtree under each node (1 when all children are leaves).
+// Parents come before their children, so one backward pass sees every child first.
+template <int W, class Node> inline void Bvh2CalcHeights(const Node *nodes, size_t numNodes, std::vector<unsigned int> *pHeights) {
+	pHeights->assign(numNodes, 1);
+	for (size_t i = numNodes; i-- > 0;) {
+		for (int k = 0; k < W; k++)
+			if (Bvh2IsInner(nodes[i], k) && (*pHeights)[nodes[i].child[k]] + 1 > (*pHeights)[i])
+				(*pHeights)[i] = (*pHeights)[nodes[i].child[k]] + 1;
+	}
+}
+
+// Append the nodes of the subtree at root, at most levels deep, in van Emde Boas order: the top half of
+// the levels first, then each subtree hanging below it, both laid out the same way.
+// pStack holds the nodes of each level of the top half while the subtrees below it are laid out.
+template <int W, class Node> inline void Bvh2VebOrder(const Node *nodes, const unsigned int *heights, unsigned int root,
+	unsigned int levels, std::vector<unsigned int> *pOrder, std::vector<unsigned int> *pStack) {
+	if (levels > heights[root])
+		levels = heights[root];
+	if (levels == 1) {
+		pOrder->push_back(root);
+		return;
+	}
+	unsigned int topLevels = levels / 2;
+	Bvh2VebOrder<W>(nodes, heights, root, topLevels, pOrder, pStack);
+	std::vector<unsigned int> &stack = *pStack;
+	size_t base = stack.size(), first = base, end = base + 1;
+	stack.push_back(root);
+	for (unsigned int d = 0; d < topLevels; d++) {
+		for (size_t i = first; i < end; i++)
+			for (int k = 0; k < W; k++)
+				if (Bvh2IsInner(nodes[stack[i]], k))
+					stack.push_back(nodes[stack[i]].child[k]);
+		first = end;
+		end = stack.size();
+	}
+	for (size_t i = first; i < end; i++)
+		Bvh2VebOrder<W>(nodes, heights, stack[i], levels - topLevels, pOrder, pStack);
+	stack.resize(base);
+}
+
+template <int W, class Node> inline void Bvh2LayoutVeb(std::vector<Node> *pNodes) {
+	std::vector<Node> &nodes = *pNodes;
+	if (nodes.empty())
+		return;
+	std::vector<unsigned int> heights, order, stack, newIndex(nodes.size());
+	Bvh2CalcHeights<W>(&nodes[0], nodes.size(), &heights);
+	order.reserve(nodes.size());
+	Bvh2VebOrder<W>(&nodes[0], &heights[0], 0, heights[0], &order, &stack);
+	for (size_t i = 0; i < order.size(); i++)
+		newIndex[order[i]] = static_cast<unsigned int>(i);
+	std::vector<Node> out(nodes.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		out[i] = nodes[order[i]];
+		for (int k = 0; k < W; k++)
+			if (Bvh2IsInner(out[i], k))
+				out[i].child[k] = newIndex[out[i].child[k]];
+	}
+	nodes.swap(out);
+}
+
+// Reorder the nodes of a built hierarchy so any subtree a few levels deep sits in a contiguous run of
+// memory, whatever the cache line and page sizes. Same tree, queries return the same list.
+template <int W> inline void Bvh2LayoutVeb(Bvh2<W> *pBvh) {
+	Bvh2LayoutVeb<W>(&pBvh->nodes);
+}
+
+template <int W> inline void Bvh2LayoutVeb(Bvh2Q<W> *pBvh) {
+	Bvh2LayoutVeb<W>(&pBvh->nodes);
+}
+
+}  // namespace
+
+#endif  // _SAW_GEOM_BVH2_INCLUDED
@@ -23,6 +23,19 @@
 
 //-----------------------------------------------------------------------------------------------------------
 // History
+// - v1.21 - 10/19/26 - Added Cd2StatsSnapshotAll, merging the counters of every thread that ran a test
+// - v1.20 - 10/19/26 - Added Dist2 for every pair of primitives (Dist2(a, b), Dist2NN) and Dist2Gap
+// - v1.19 - 10/19/26 - Added Cd2ObbsO and Cd2ObbsObbs: SoA obb tests against one obb or pairwise
+// - v1.18 - 10/19/26 - Added Capsule2 with tests against every primitive, Dist2 functions and Cd2PointsCap
+// - v1.17 - 10/19/26 - Added runtime cpu dispatch (Cd2GetCpuLevel, SAWG_CPU) with AVX2 and AVX-512 batch point tests
+// - v1.16 - 10/19/26 - Added Cd2Points* batch point tests against one shape (SSE2), as bitmask or index list
+// - v1.15 - 10/19/26 - Added Prim2GetComps
+// - v1.14 - 10/19/26 - Added Cd2(a, b) resolved at compile time for any pair, and Shape2 (tagged primitive)
+// - v1.13 - 10/19/26 - Added CalcAabb2Soa batch bounds (SSE2) with fatten margin
+// - v1.12 - 10/19/26 - Added CalcAabb2 for every primitive
+//                    - Added SAW_GEOM_SSE2 detection for SIMD batch code
+// - v1.11 - 10/19/26 - Added Prim2Type and Prim2Info for code that handles primitives generically
+// - v1.10 - 10/19/26 - Added opt-in per-test statistics (calls, hits, early-out stage) with SAW_GEOM_CD2_STATS
 // - v1.09 - 03/12/16 - Added squared distance for P <-> P, P <-> Ls, P <-> C, C <-> C, C <-> P, Ls <-> P
 //                    - Cd2CLs/Cd2LsC returns intersection point
 // - v1.08 - 05/27/13 - Cd2LsLs returns intersection point
@@ -49,10 +62,29 @@
 //-----------------------------------------------------------------------------------------------------------
 // Notes
 // - Primitives 
-//   - Point2, Aabb2, Obb2, LineSeg2, Triangle2, Circle2
+//   - Point2, Aabb2, Obb2, LineSeg2, Triangle2, Circle2, Capsule2
+//   - Capsule2 is a line segment grown by a radius. One capsule stands in for a chain of circles (a
+//     character, a swept bullet); its tests reuse the segment distance of Dist2PLs, so a capsule with
+//     both ends at the same point gives the same answers as the circle there.
+//   - Prim2Type/Prim2Info give each a type id and float count
 //
 // - Utility 
 //   - CalcLen2, Normalize2, CalcDot2, IsClockwise2, Project2, Unproject2, Rotate2, PolarToXy2, XyToPolar2
+//   - CalcAabb2 (bounds of any primitive)
+//   - CalcAabb2Soa (bounds of n primitives stored as structure-of-arrays, optionally fattened)
+//
+// - SIMD
+//   - SAW_GEOM_SSE2 is defined when compiling for SSE2 (any x64 target). Define SAW_GEOM_NO_SIMD
+//     before inclusion to force the scalar paths.
+//   - Batch kernels pick their width at run time from Cd2GetCpuLevel: scalar, SSE2, AVX2 or AVX-512,
+//     found with cpuid (and the OS saving the registers) on first use. One binary runs at its best on
+//     every host. AVX2 and AVX-512 kernels are compiled with target attributes (GCC, Clang) or
+//     directly (MSVC); SAW_GEOM_DISPATCH is defined when they are. Define SAW_GEOM_NO_DISPATCH to
+//     keep to SSE2.
+//   - The SAWG_CPU environment variable (scalar, sse2, avx2, avx512) lowers the level for testing;
+//     Cd2SetCpuLevel does the same from code. Neither can raise it above what the host supports.
+//   - Every level gives the same results: the wide kernels do the scalar math in the same order and
+//     are compiled without fused multiply-add
 //
 // - Collision Detection 
 //   - Any primitive with any primitive
@@ -60,8 +92,42 @@
 //   - (Collision detection only; NOT collision response)
 //   - (Some methods are naive)
 //
+// - Generic
+//   - Cd2(a, b) picks the implementation for the pair at compile time, either argument order.
+//     Only one order of each pair is registered (Cd2Dispatch); the reverse swaps the arguments.
+//     Intersection points (pOut) are not produced; call the named functions for those.
+//   - Shape2 holds any primitive with its type tag. Shape2Visit calls a functor with the concrete
+//     primitive, Cd2(Shape2, Shape2) dispatches on both tags, and Shape2SortByType groups shapes so a
+//     loop over each type (Cd2Each) inlines its test.
+//
+// - Batch Point Tests
+//   - Cd2PointsA/O/T/C/Cap/N test n points (x and y arrays) against one aabb, obb, triangle, circle,
+//     capsule or convex polygon, 4, 8 or 16 at a time (SSE2, AVX2 or AVX-512 by Cd2GetCpuLevel).
+//     Results are bits (Cd2PointsGetMaskSize words, bit i of the mask is point i) and equal Cd2AP,
+//     Cd2PO, Cd2PT, Cd2CP, Cd2CapP and Cd2NN one point at a time.
+//   - Cd2PointsGetIndices compacts a mask to the indices of the points inside
+//   - Cd2ObbsO and Cd2ObbsObbs do the same for obbs (SoA as CalcAabb2Soa) against one obb, or pair i of
+//     two arrays, with the four axes of each pair in lanes. Results equal Cd2OO one pair at a time.
+//   - Not counted by SAW_GEOM_CD2_STATS
+//
 // - Squared Distance
 //   - Point <-> Point, Point <-> Circle, Point <-> LineSeg, Circle <-> Circle
+//   - Point <-> Aabb, LineSeg <-> LineSeg, Capsule <-> Point, Circle, LineSeg, Capsule
+//   - Like those with circles, capsule distances are the squared distance between the cores (segment,
+//     center) less the squared radii
+//   - The rest of the matrix (Dist2AO, Dist2OT, Dist2TCap, ...) and Dist2(a, b) for any pair go through
+//     Dist2NN, the squared distance between convex vertex lists (0 if they overlap). Cores are 1 to 4
+//     vertices: a point, a segment, a triangle or the corners of an aabb or obb.
+//   - Dist2Gap(a, b) is the squared length of the shortest segment between the two shapes, 0 if they
+//     touch: radii are taken off before squaring, so unlike Dist2 it orders shapes by clearance and is
+//     never below the gap between their bounds (as wanted by Bvh2QueryNearest)
+//
+// - Statistics
+//   - Define SAW_GEOM_CD2_STATS before inclusion to count calls, hits and early-out stage of every test
+//   - Counters are per thread; snapshot them with Cd2StatsSnapshot and combine with Cd2StatsMerge
+//   - Each thread's counters are registered on its first test and kept after it exits. Cd2StatsSnapshotAll
+//     merges all of them (ie after a threaded Cd2NarrowPhase); call it while no tests run on other threads.
+//   - When not defined, tests compile exactly as before and the counters stay zero
 
 //-----------------------------------------------------------------------------------------------------------
 // Todo
@@ -73,6 +139,37 @@
 #define _SAW_GEOM_CD2_INCLUDED
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef SAW_GEOM_CD2_STATS
+#	include <mutex>
+#	include <vector>
+#endif
+
+#if !defined(SAW_GEOM_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#	define SAW_GEOM_SSE2
+#	include <emmintrin.h>
+#endif
+
+#if defined(SAW_GEOM_SSE2) && !defined(SAW_GEOM_NO_DISPATCH) && \
+	(defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5) || (defined(_MSC_VER) && _MSC_VER >= 1910))
+#	define SAW_GEOM_DISPATCH
+#	include <immintrin.h>
+#	if defined(_MSC_VER) && !defined(__clang__)
+#		include <intrin.h>
+#		define SAW_GEOM_TARGET_AVX2
+#		define SAW_GEOM_TARGET_AVX512
+#	else
+#		include <cpuid.h>
+#		if defined(__clang__)
+#			define SAW_GEOM_TARGET_AVX2 __attribute__((target("avx2")))
+#			define SAW_GEOM_TARGET_AVX512 __attribute__((target("avx512f")))
+#		else  // GCC would otherwise fuse multiplies and adds under avx512f (it implies fma)
+#			define SAW_GEOM_TARGET_AVX2 __attribute__((target("avx2"), optimize("fp-contract=off")))
+#			define SAW_GEOM_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#		endif
+#	endif
+#endif
 
 namespace sawg {
 
@@ -130,6 +227,136 @@ struct Circle2 {
 	float GetArea() const { return 3.1415927f * r * r; }
 };
 
+//-----------------------------------------------------------------------------------------------------------
+// Every point within r of the segment from x1, y1 to x2, y2
+struct Capsule2 {
+	float x1, y1, x2, y2, r;
+	Capsule2() { }
+	Capsule2(float x1, float y1, float x2, float y2, float r) : x1(x1), y1(y1), x2(x2), y2(y2), r(r) { }
+	float GetArea() const { return 3.1415927f * r * r + sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)) * fabs(r) * 2; }
+};
+
+//-----------------------------------------------------------------------------------------------------------
+// Type ids, for code that stores or dispatches on primitives generically
+enum Prim2Type {
+	PRIM2_POINT,
+	PRIM2_AABB,
+	PRIM2_OBB,
+	PRIM2_LINESEG,
+	PRIM2_TRIANGLE,
+	PRIM2_CIRCLE,
+	PRIM2_CAPSULE,
+	PRIM2_COUNT
+};
+
+// Most floats in any primitive
+static const int PRIM2_MAX_COMPS = 6;
+
+// Type id and number of floats of each primitive. Primitives are plain floats in declaration order.
+template <class T> struct Prim2Info;
+template <> struct Prim2Info<Point2> { static const Prim2Type TYPE = PRIM2_POINT; static const int COMPS = 2; };
+template <> struct Prim2Info<Aabb2> { static const Prim2Type TYPE = PRIM2_AABB; static const int COMPS = 4; };
+template <> struct Prim2Info<Obb2> { static const Prim2Type TYPE = PRIM2_OBB; static const int COMPS = 6; };
+template <> struct Prim2Info<LineSeg2> { static const Prim2Type TYPE = PRIM2_LINESEG; static const int COMPS = 4; };
+template <> struct Prim2Info<Triangle2> { static const Prim2Type TYPE = PRIM2_TRIANGLE; static const int COMPS = 6; };
+template <> struct Prim2Info<Circle2> { static const Prim2Type TYPE = PRIM2_CIRCLE; static const int COMPS = 3; };
+template <> struct Prim2Info<Capsule2> { static const Prim2Type TYPE = PRIM2_CAPSULE; static const int COMPS = 5; };
+
+// Prim2Info<T>::COMPS of a runtime type
+inline int Prim2GetComps(Prim2Type type) {
+	static const int comps[PRIM2_COUNT] = { Prim2Info<Point2>::COMPS, Prim2Info<Aabb2>::COMPS,
+		Prim2Info<Obb2>::COMPS, Prim2Info<LineSeg2>::COMPS, Prim2Info<Triangle2>::COMPS, Prim2Info<Circle2>::COMPS,
+		Prim2Info<Capsule2>::COMPS };
+	return type >= 0 && type < PRIM2_COUNT ? comps[type] : 0;
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// CPU DISPATCH
+//-----------------------------------------------------------------------------------------------------------
+
+enum Cd2CpuLevel {
+	CD2_CPU_SCALAR,
+	CD2_CPU_SSE2,
+	CD2_CPU_AVX2,
+	CD2_CPU_AVX512,
+	CD2_CPU_COUNT
+};
+
+inline const char *Cd2GetCpuLevelName(Cd2CpuLevel level) {
+	static const char *names[CD2_CPU_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+	return static_cast<unsigned int>(level) < CD2_CPU_COUNT ? names[level] : "";
+}
+
+// Best level this build can run on this host
+inline Cd2CpuLevel Cd2DetectCpuLevel() {
+#if defined(SAW_GEOM_DISPATCH)
+	unsigned int regs[4] = { 0, 0, 0, 0 }, leaf7[4] = { 0, 0, 0, 0 };
+#	if defined(_MSC_VER) && !defined(__clang__)
+	int r[4];
+	__cpuid(r, 0);
+	unsigned int maxLeaf = static_cast<unsigned int>(r[0]);
+	__cpuid(r, 1);
+	for (int i = 0; i < 4; i++) regs[i] = static_cast<unsigned int>(r[i]);
+	if (maxLeaf >= 7) {
+		__cpuidex(r, 7, 0);
+		for (int i = 0; i < 4; i++) leaf7[i] = static_cast<unsigned int>(r[i]);
+	}
+#	else
+	unsigned int maxLeaf = __get_cpuid_max(0, 0);
+	__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+	if (maxLeaf >= 7)
+		__cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#	endif
+	// The OS must save the wider registers on context switch (xgetbv, enabled by OSXSAVE)
+	unsigned long long xcr0 = 0;
+	if (regs[2] & (1u << 27)) {
+#	if defined(_MSC_VER) && !defined(__clang__)
+		xcr0 = _xgetbv(0);
+#	else
+		unsigned int lo, hi;
+		__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		xcr0 = (static_cast<unsigned long long>(hi) << 32) | lo;
+#	endif
+	}
+	bool avx2 = (xcr0 & 0x6) == 0x6 && (leaf7[1] & (1u << 5));
+	bool avx512 = avx2 && (xcr0 & 0xe6) == 0xe6 && (leaf7[1] & (1u << 16));
+	return avx512 ? CD2_CPU_AVX512 : avx2 ? CD2_CPU_AVX2 : CD2_CPU_SSE2;
+#elif defined(SAW_GEOM_SSE2)
+	return CD2_CPU_SSE2;
+#else
+	return CD2_CPU_SCALAR;
+#endif
+}
+
+// Detected level, lowered by the SAWG_CPU environment variable if set
+inline Cd2CpuLevel Cd2GetEnvCpuLevel() {
+	Cd2CpuLevel level = Cd2DetectCpuLevel();
+	const char *env = getenv("SAWG_CPU");
+	for (int i = 0; env && i < level; i++) {
+		if (strcmp(env, Cd2GetCpuLevelName(static_cast<Cd2CpuLevel>(i))) == 0)
+			return static_cast<Cd2CpuLevel>(i);
+	}
+	return level;
+}
+
+inline Cd2CpuLevel &Cd2GetCpuLevelRef() {
+	static Cd2CpuLevel level = Cd2GetEnvCpuLevel();
+	return level;
+}
+
+// Level the batch kernels use. Found once, on first use.
+inline Cd2CpuLevel Cd2GetCpuLevel() {
+	return Cd2GetCpuLevelRef();
+}
+
+// Use a lower level (for tests and comparisons); clamped to the detected level. Returns the level set.
+// Not synchronized with kernels running on other threads.
+inline Cd2CpuLevel Cd2SetCpuLevel(Cd2CpuLevel level) {
+	Cd2CpuLevel best = Cd2DetectCpuLevel();
+	Cd2GetCpuLevelRef() = level < best ? (level > CD2_CPU_SCALAR ? level : CD2_CPU_SCALAR) : best;
+	return Cd2GetCpuLevelRef();
+}
+
 //-----------------------------------------------------------------------------------------------------------
 // UTILITY
 //-----------------------------------------------------------------------------------------------------------
@@ -203,17 +430,332 @@ inline void XyToPolar2(float x, float y, float *pRad, float *pDist) {
 	*pDist = sqrt(x * x + y * y);
 }
 
+// Bounds of a primitive
+inline Aabb2 CalcAabb2(const Point2 &p) { return Aabb2(p.x, p.y, p.x, p.y); }
+inline Aabb2 CalcAabb2(const Aabb2 &a) { return a; }
+inline Aabb2 CalcAabb2(const Obb2 &o) {
+	// Same extents as the aabb axes test in Cd2AO
+	float halfW = fabs(o.halfW * o.orientX) + fabs(o.halfH * o.orientY);
+	float halfH = fabs(o.halfH * o.orientX) + fabs(o.halfW * o.orientY);
+	return Aabb2(o.cx - halfW, o.cy - halfH, o.cx + halfW, o.cy + halfH);
+}
+inline Aabb2 CalcAabb2(const LineSeg2 &ls) {
+	return Aabb2(ls.x1 < ls.x2 ? ls.x1 : ls.x2, ls.y1 < ls.y2 ? ls.y1 : ls.y2, ls.x1 < ls.x2 ? ls.x2 : ls.x1, ls.y1 < ls.y2 ? ls.y2 : ls.y1);
+}
+inline Aabb2 CalcAabb2(const Triangle2 &t) {
+	Aabb2 a(t.x1, t.y1, t.x1, t.y1);
+	if (t.x2 < a.minX) a.minX = t.x2;
+	if (t.x3 < a.minX) a.minX = t.x3;
+	if (t.x2 > a.maxX) a.maxX = t.x2;
+	if (t.x3 > a.maxX) a.maxX = t.x3;
+	if (t.y2 < a.minY) a.minY = t.y2;
+	if (t.y3 < a.minY) a.minY = t.y3;
+	if (t.y2 > a.maxY) a.maxY = t.y2;
+	if (t.y3 > a.maxY) a.maxY = t.y3;
+	return a;
+}
+inline Aabb2 CalcAabb2(const Circle2 &c) {
+	float r = fabs(c.r);
+	return Aabb2(c.x - r, c.y - r, c.x + r, c.y + r);
+}
+inline Aabb2 CalcAabb2(const Capsule2 &k) {
+	Aabb2 a = CalcAabb2(LineSeg2(k.x1, k.y1, k.x2, k.y2));
+	float r = fabs(k.r);
+	return Aabb2(a.minX - r, a.minY - r, a.maxX + r, a.maxY + r);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// Batch bounds of primitives stored as structure-of-arrays.
+// comps[k] is the array of the primitive's k-th member, in declaration order (Prim2Info<T>::COMPS arrays).
+// pOut is minX, minY, maxX, maxY arrays; every box is grown by margin on all sides.
+// Results equal CalcAabb2 followed by the margin, SIMD or not. SSE2 is used from CD2_CPU_SSE2 up (memory
+// bound, so wider kernels would gain little).
+
+inline void CalcAabb2SoaStore(const Aabb2 &a, float margin, float *const pOut[4], size_t i) {
+	pOut[0][i] = a.minX - margin;
+	pOut[1][i] = a.minY - margin;
+	pOut[2][i] = a.maxX + margin;
+	pOut[3][i] = a.maxY + margin;
+}
+
+#ifdef SAW_GEOM_SSE2
+inline void CalcAabb2SoaStore4(__m128 minX, __m128 minY, __m128 maxX, __m128 maxY, __m128 margin, float *const pOut[4], size_t i) {
+	_mm_storeu_ps(pOut[0] + i, _mm_sub_ps(minX, margin));
+	_mm_storeu_ps(pOut[1] + i, _mm_sub_ps(minY, margin));
+	_mm_storeu_ps(pOut[2] + i, _mm_add_ps(maxX, margin));
+	_mm_storeu_ps(pOut[3] + i, _mm_add_ps(maxY, margin));
+}
+
+inline __m128 CalcAabb2Abs4(__m128 v) {
+	return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+#endif
+
+inline void CalcAabb2SoaPoint(const float *const comps[2], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(comps[0] + i), y = _mm_loadu_ps(comps[1] + i);
+		CalcAabb2SoaStore4(x, y, x, y, m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(Point2(comps[0][i], comps[1][i])), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaAabb(const float *const comps[4], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4)
+		CalcAabb2SoaStore4(_mm_loadu_ps(comps[0] + i), _mm_loadu_ps(comps[1] + i), _mm_loadu_ps(comps[2] + i),
+			_mm_loadu_ps(comps[3] + i), m, pOut, i);
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(Aabb2(comps[0][i], comps[1][i], comps[2][i], comps[3][i]), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaObb(const float *const comps[6], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 cx = _mm_loadu_ps(comps[0] + i), cy = _mm_loadu_ps(comps[1] + i);
+		__m128 ox = _mm_loadu_ps(comps[2] + i), oy = _mm_loadu_ps(comps[3] + i);
+		__m128 hw = _mm_loadu_ps(comps[4] + i), hh = _mm_loadu_ps(comps[5] + i);
+		__m128 extX = _mm_add_ps(CalcAabb2Abs4(_mm_mul_ps(hw, ox)), CalcAabb2Abs4(_mm_mul_ps(hh, oy)));
+		__m128 extY = _mm_add_ps(CalcAabb2Abs4(_mm_mul_ps(hh, ox)), CalcAabb2Abs4(_mm_mul_ps(hw, oy)));
+		CalcAabb2SoaStore4(_mm_sub_ps(cx, extX), _mm_sub_ps(cy, extY), _mm_add_ps(cx, extX), _mm_add_ps(cy, extY), m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(Obb2(comps[0][i], comps[1][i], comps[2][i], comps[3][i], comps[4][i], comps[5][i])), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaLineSeg(const float *const comps[4], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 x1 = _mm_loadu_ps(comps[0] + i), y1 = _mm_loadu_ps(comps[1] + i);
+		__m128 x2 = _mm_loadu_ps(comps[2] + i), y2 = _mm_loadu_ps(comps[3] + i);
+		CalcAabb2SoaStore4(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2), _mm_max_ps(x1, x2), _mm_max_ps(y1, y2), m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(LineSeg2(comps[0][i], comps[1][i], comps[2][i], comps[3][i])), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaTriangle(const float *const comps[6], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 x1 = _mm_loadu_ps(comps[0] + i), y1 = _mm_loadu_ps(comps[1] + i);
+		__m128 x2 = _mm_loadu_ps(comps[2] + i), y2 = _mm_loadu_ps(comps[3] + i);
+		__m128 x3 = _mm_loadu_ps(comps[4] + i), y3 = _mm_loadu_ps(comps[5] + i);
+		CalcAabb2SoaStore4(_mm_min_ps(_mm_min_ps(x1, x2), x3), _mm_min_ps(_mm_min_ps(y1, y2), y3),
+			_mm_max_ps(_mm_max_ps(x1, x2), x3), _mm_max_ps(_mm_max_ps(y1, y2), y3), m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(Triangle2(comps[0][i], comps[1][i], comps[2][i], comps[3][i], comps[4][i], comps[5][i])), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaCircle(const float *const comps[3], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(comps[0] + i), y = _mm_loadu_ps(comps[1] + i);
+		__m128 r = CalcAabb2Abs4(_mm_loadu_ps(comps[2] + i));
+		CalcAabb2SoaStore4(_mm_sub_ps(x, r), _mm_sub_ps(y, r), _mm_add_ps(x, r), _mm_add_ps(y, r), m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(Circle2(comps[0][i], comps[1][i], comps[2][i])), margin, pOut, i);
+}
+
+inline void CalcAabb2SoaCapsule(const float *const comps[5], size_t n, float margin, float *const pOut[4]) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	bool simd = Cd2GetCpuLevel() >= CD2_CPU_SSE2;
+	__m128 m = _mm_set1_ps(margin);
+	for (; simd && i + 4 <= n; i += 4) {
+		__m128 x1 = _mm_loadu_ps(comps[0] + i), y1 = _mm_loadu_ps(comps[1] + i);
+		__m128 x2 = _mm_loadu_ps(comps[2] + i), y2 = _mm_loadu_ps(comps[3] + i);
+		__m128 r = CalcAabb2Abs4(_mm_loadu_ps(comps[4] + i));
+		CalcAabb2SoaStore4(_mm_sub_ps(_mm_min_ps(x1, x2), r), _mm_sub_ps(_mm_min_ps(y1, y2), r),
+			_mm_add_ps(_mm_max_ps(x1, x2), r), _mm_add_ps(_mm_max_ps(y1, y2), r), m, pOut, i);
+	}
+#endif
+	for (; i < n; i++)
+		CalcAabb2SoaStore(CalcAabb2(Capsule2(comps[0][i], comps[1][i], comps[2][i], comps[3][i], comps[4][i])), margin, pOut, i);
+}
+
+// Any primitive type
+inline void CalcAabb2Soa(Prim2Type type, const float *const *comps, size_t n, float margin, float *const pOut[4]) {
+	switch (type) {
+	case PRIM2_POINT: CalcAabb2SoaPoint(comps, n, margin, pOut); break;
+	case PRIM2_AABB: CalcAabb2SoaAabb(comps, n, margin, pOut); break;
+	case PRIM2_OBB: CalcAabb2SoaObb(comps, n, margin, pOut); break;
+	case PRIM2_LINESEG: CalcAabb2SoaLineSeg(comps, n, margin, pOut); break;
+	case PRIM2_TRIANGLE: CalcAabb2SoaTriangle(comps, n, margin, pOut); break;
+	case PRIM2_CIRCLE: CalcAabb2SoaCircle(comps, n, margin, pOut); break;
+	case PRIM2_CAPSULE: CalcAabb2SoaCapsule(comps, n, margin, pOut); break;
+	default: break;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// STATISTICS
+//-----------------------------------------------------------------------------------------------------------
+// One id per collision test. Reversed tests (Cd2CA, Cd2TO, ...) forward to, and are counted as, the
+// implementation they call. Nested tests are counted too (Cd2CO also counts a Cd2AC call).
+//
+// Stage is the index of the return statement a test left through, in source order:
+//   NN   0 - separated on an axis of polygon 1, 1 - on an axis of polygon 2, 2 - overlap
+//   ALs  0 - x axis, 1 - y axis, 2 - axis perpendicular to the segment, 3 - overlap
+//   AT   0 - triangle bounds, 1 - triangle edge axes, 2 - overlap
+//   AO   0 - aabb axes, 1 - obb axes, 2 - overlap
+//   OO   0 - axes of obb 1, 1 - axes of obb 2, 2 - overlap
+//   CT   0 - center inside triangle, 1 - edge tests
+//   PLs  0 - vertical segment, 1 - outside x range, 2 - on line test
+//   PT   0 - degenerate triangle, 1 - edge sign test
+//   LsLs 0 - collinear, 1 - intersection, 2 - no intersection
+//   LsT  0 - end point inside triangle, 1 - edge tests
+//   CapA 0 - end point inside aabb, 1 - distance to the edges
+//   CapT 0 - segment meets the triangle, 1 - distance test
+//   Everything else returns from stage 0.
+enum Cd2StatId {
+	CD2_STAT_NN, CD2_STAT_AA, CD2_STAT_AP, CD2_STAT_AC, CD2_STAT_ALS, CD2_STAT_AT, CD2_STAT_AO,
+	CD2_STAT_CC, CD2_STAT_CLS, CD2_STAT_CP, CD2_STAT_CT, CD2_STAT_CO, CD2_STAT_PP, CD2_STAT_PLS,
+	CD2_STAT_PT, CD2_STAT_PO, CD2_STAT_OLS, CD2_STAT_OO, CD2_STAT_OT, CD2_STAT_LSLS, CD2_STAT_LST,
+	CD2_STAT_TT, CD2_STAT_CAPP, CD2_STAT_CAPA, CD2_STAT_CAPC, CD2_STAT_CAPLS, CD2_STAT_CAPT, CD2_STAT_CAPO,
+	CD2_STAT_CAPCAP,
+	CD2_STAT_COUNT
+};
+
+static const int CD2_STAT_MAX_STAGES = 4;
+
+struct Cd2Stats {
+	unsigned long long calls[CD2_STAT_COUNT];
+	unsigned long long hits[CD2_STAT_COUNT];
+	unsigned long long exits[CD2_STAT_COUNT][CD2_STAT_MAX_STAGES];  // Calls that returned from each stage
+};
+
+// Name of a test ("Cd2AT"), for dumping
+inline const char *Cd2StatsGetName(Cd2StatId id) {
+	static const char *names[CD2_STAT_COUNT] = {
+		"Cd2NN", "Cd2AA", "Cd2AP", "Cd2AC", "Cd2ALs", "Cd2AT", "Cd2AO", "Cd2CC", "Cd2CLs", "Cd2CP", "Cd2CT",
+		"Cd2CO", "Cd2PP", "Cd2PLs", "Cd2PT", "Cd2PO", "Cd2OLs", "Cd2OO", "Cd2OT", "Cd2LsLs", "Cd2LsT", "Cd2TT",
+		"Cd2CapP", "Cd2CapA", "Cd2CapC", "Cd2CapLs", "Cd2CapT", "Cd2CapO", "Cd2CapCap" };
+	return id >= 0 && id < CD2_STAT_COUNT ? names[id] : "";
+}
+
+inline void Cd2StatsClear(Cd2Stats *pStats) {
+	for (int i = 0; i < CD2_STAT_COUNT; i++) {
+		pStats->calls[i] = pStats->hits[i] = 0;
+		for (int j = 0; j < CD2_STAT_MAX_STAGES; j++)
+			pStats->exits[i][j] = 0;
+	}
+}
+
+inline void Cd2StatsMerge(Cd2Stats *pDst, const Cd2Stats &src) {
+	for (int i = 0; i < CD2_STAT_COUNT; i++) {
+		pDst->calls[i] += src.calls[i];
+		pDst->hits[i] += src.hits[i];
+		for (int j = 0; j < CD2_STAT_MAX_STAGES; j++)
+			pDst->exits[i][j] += src.exits[i][j];
+	}
+}
+
+#ifdef SAW_GEOM_CD2_STATS
+// Counters of every thread that ran a test
+struct Cd2StatsRegistry {
+	std::mutex lock;
+	std::vector<Cd2Stats *> threads;
+};
+
+inline Cd2StatsRegistry &Cd2StatsGetRegistry() {
+	static Cd2StatsRegistry registry;
+	return registry;
+}
+
+// Counters of the calling thread, registered on first use
+inline Cd2Stats &Cd2StatsGetLocal() {
+	static thread_local Cd2Stats *pStats = 0;
+	if (!pStats) {
+		pStats = new Cd2Stats();
+		Cd2StatsRegistry &r = Cd2StatsGetRegistry();
+		std::lock_guard<std::mutex> guard(r.lock);
+		r.threads.push_back(pStats);
+	}
+	return *pStats;
+}
+
+inline bool Cd2StatsRecord(Cd2StatId id, int stage, bool ret) {
+	Cd2Stats &stats = Cd2StatsGetLocal();
+	stats.calls[id]++;
+	stats.exits[id][stage]++;
+	if (ret)
+		stats.hits[id]++;
+	return ret;
+}
+#	define SAW_CD2_RET(id, stage, ret) Cd2StatsRecord(id, stage, ret)
+#else
+#	define SAW_CD2_RET(id, stage, ret) (ret)
+#endif
+
+// Copy the calling thread's counters, optionally resetting them (ie once per frame)
+// Always zero if SAW_GEOM_CD2_STATS is not defined.
+inline void Cd2StatsSnapshot(Cd2Stats *pOut, bool reset) {
+#ifdef SAW_GEOM_CD2_STATS
+	*pOut = Cd2StatsGetLocal();
+	if (reset)
+		Cd2StatsClear(&Cd2StatsGetLocal());
+#else
+	(void)reset;
+	Cd2StatsClear(pOut);
+#endif
+}
+
+// Merge the counters of every thread, optionally resetting them. Other threads must not be running tests.
+// Always zero if SAW_GEOM_CD2_STATS is not defined.
+inline void Cd2StatsSnapshotAll(Cd2Stats *pOut, bool reset) {
+	Cd2StatsClear(pOut);
+#ifdef SAW_GEOM_CD2_STATS
+	Cd2StatsRegistry &r = Cd2StatsGetRegistry();
+	std::lock_guard<std::mutex> guard(r.lock);
+	for (size_t i = 0; i < r.threads.size(); i++) {
+		Cd2StatsMerge(pOut, *r.threads[i]);
+		if (reset)
+			Cd2StatsClear(r.threads[i]);
+	}
+#else
+	(void)reset;
+#endif
+}
+
 //-----------------------------------------------------------------------------------------------------------
 // COLLISION DETECTION
 //-----------------------------------------------------------------------------------------------------------
-//      A  P  C  Ls T  O  N
-//  A   X  X  X  X  X  X
-//  P   X  X  X  X  X  X
-//  C   X  X  X  X  X  X
-//  Ls  X  X  X  X  X  X
-//  T   X  X  X  X  X  X
-//  O   X  X  X  X  X  X
-//  N                     X
+//      A  P  C  Ls T  O  Cap N
+//  A   X  X  X  X  X  X  X
+//  P   X  X  X  X  X  X  X
+//  C   X  X  X  X  X  X  X
+//  Ls  X  X  X  X  X  X  X
+//  T   X  X  X  X  X  X  X
+//  O   X  X  X  X  X  X  X
+//  Cap X  X  X  X  X  X  X
+//  N                         X
 
 // Collision detection 2d: convex n-sided and convex n-sided
 inline bool Cd2NN(const float *px1, const float *py1, int n1, const float *px2, const float *py2, int n2) {
@@ -242,21 +784,21 @@ inline bool Cd2NN(const float *px1, const float *py1, int n1, const float *px2,
 				}
 			}
 			if (mn[0] > mx[1] || mx[0] < mn[1])
-				return false;
+				return SAW_CD2_RET(CD2_STAT_NN, i, false);
 			lastJ = j;
 		}
 	}
-	return true;
+	return SAW_CD2_RET(CD2_STAT_NN, 2, true);
 }
 
 // Collision detection 2d: Aabb and Aabb
 inline bool Cd2AA(const Aabb2 &a1, const Aabb2 &a2) {
-	return a1.minX <= a2.maxX && a1.maxX >= a2.minX && a1.minY <= a2.maxY && a1.maxY >= a2.minY;
+	return SAW_CD2_RET(CD2_STAT_AA, 0, a1.minX <= a2.maxX && a1.maxX >= a2.minX && a1.minY <= a2.maxY && a1.maxY >= a2.minY);
 }
 
 // Collision detection 2d: Aabb and Point
 inline bool Cd2AP(const Aabb2 &a, const Point2 &p) {
-	return (p.x >= a.minX && p.x <= a.maxX && p.y >= a.minY && p.y <= a.maxY);
+	return SAW_CD2_RET(CD2_STAT_AP, 0, p.x >= a.minX && p.x <= a.maxX && p.y >= a.minY && p.y <= a.maxY);
 }
 
 // Collision detection 2d: Aabb and Circle
@@ -269,7 +811,7 @@ inline bool Cd2AC(const Aabb2 &a, const Circle2 &c) {
 	if (cy > a.maxY)
 		cy = a.maxY;
 	float dx = cx - c.x, dy = cy - c.y;
-	return dx * dx + dy * dy <= c.r * c.r;
+	return SAW_CD2_RET(CD2_STAT_AC, 0, dx * dx + dy * dy <= c.r * c.r);
 }
 
 // Collision detection 2d: Aabb and Line Segment
@@ -284,12 +826,12 @@ inline bool Cd2ALs(const Aabb2 &a, const LineSeg2 &ls) {
 	float adx = fabs(hlx);
 	float ady = fabs(hly);
 	if (cx > hax + adx)  // Check projection onto x axis
-		return false;
+		return SAW_CD2_RET(CD2_STAT_ALS, 0, false);
 	if (cy > hay + ady)  // Check projection onto y axis
-		return false;
+		return SAW_CD2_RET(CD2_STAT_ALS, 1, false);
 	if (adx * cy + ady * cx > ady * hax + adx * hay + .00001f)  // Check proj. onto axis perp. to line
-		return false;
-	return true;
+		return SAW_CD2_RET(CD2_STAT_ALS, 2, false);
+	return SAW_CD2_RET(CD2_STAT_ALS, 3, true);
 }
 
 // Collision detection 2d: Aabb and Triangle
@@ -301,7 +843,7 @@ inline bool Cd2AT(const Aabb2 &a, const Triangle2 &t) {
 	if (t.y2 < minTy) minTy = t.y2; if (t.y3 < minTy) minTy = t.y3;
 	if (t.y2 > maxTy) maxTy = t.y2; if (t.y3 > maxTy) maxTy = t.y3;
 	if (a.minX > maxTx || a.maxX < minTx || a.minY > maxTy || a.maxY < minTy)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_AT, 0, false);
 
 	const float pvx[7] = { t.x1, t.x2, t.x3, a.minX, a.minX, a.maxX, a.maxX };
 	const float pvy[7] = { t.y1, t.y2, t.y3, a.minY, a.maxY, a.minY, a.maxY };
@@ -324,10 +866,10 @@ inline bool Cd2AT(const Aabb2 &a, const Triangle2 &t) {
 				mx[i[l]] = d;
 		}
 		if (mn[0] > mx[1] || mx[0] < mn[1])
-			return false;
+			return SAW_CD2_RET(CD2_STAT_AT, 1, false);
 		lastJ = j;
 	}
-	return true;
+	return SAW_CD2_RET(CD2_STAT_AT, 2, true);
 }
 
 // Collision detection 2d: Aabb and Obb
@@ -336,7 +878,7 @@ inline bool Cd2AO(const Aabb2 &a, const Obb2 &o) {
 	float halfW = fabs(o.halfW * o.orientX) + fabs(o.halfH * o.orientY);
 	float halfH = fabs(o.halfH * o.orientX) + fabs(o.halfW * o.orientY);
 	if (a.minX > o.cx + halfW || a.maxX < o.cx - halfW || a.minY > o.cy + halfH || a.maxY < o.cy - halfH)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_AO, 0, false);
 
 	// Test aabb against obb axes
 	float cx1 = 0, cy1 = 0, cx2 = 0, cy2 = 0;
@@ -349,9 +891,9 @@ inline bool Cd2AO(const Aabb2 &a, const Obb2 &o) {
 	halfW = fabs(o.halfW);
 	halfH = fabs(o.halfH);
 	if (cx2 - halfW > cx1 + ahalfW || cx2 + halfW < cx1 - ahalfW || cy2 - halfH > cy1 + ahalfH || cy2 + halfH < cy1 - ahalfH)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_AO, 1, false);
 
-	return true;
+	return SAW_CD2_RET(CD2_STAT_AO, 2, true);
 }
 
 // Collision detection 2d: Circle and Circle
@@ -359,7 +901,7 @@ inline bool Cd2CC(const Circle2 &c1, const Circle2 &c2) {
 	float dx = c1.x - c2.x;
 	float dy = c1.y - c2.y;
 	float dr = fabs(c1.r) + fabs(c2.r);
-	return dx * dx + dy * dy <= dr * dr;
+	return SAW_CD2_RET(CD2_STAT_CC, 0, dx * dx + dy * dy <= dr * dr);
 }
 
 // Collision detection 2d: Circle and Aabb
@@ -392,15 +934,15 @@ inline bool Cd2CLs(Point2 *pOut, const Circle2 &c, const LineSeg2 &ls) {
 			pOut->x = ls.x1 + C * alpha;
 			pOut->y = ls.y1 + D * alpha;
 		}
-		return true;
+		return SAW_CD2_RET(CD2_STAT_CLS, 0, true);
 	}
-	return false;
+	return SAW_CD2_RET(CD2_STAT_CLS, 0, false);
 }
 
 // Collision detection 2d: Circle and Point
 inline bool Cd2CP(const Circle2 &c, const Point2 &p) {
 	float dx = c.x - p.x, dy = c.y - p.y;
-	return (dx * dx + dy * dy <= c.r * c.r);
+	return SAW_CD2_RET(CD2_STAT_CP, 0, dx * dx + dy * dy <= c.r * c.r);
 }
 
 // Collision detection 2d: Circle and Triangle
@@ -412,12 +954,12 @@ inline bool Cd2CT(const Circle2 &c, const Triangle2 &tri) {
 	bool b2 = (c.x - tri.x2) * (tri.y3 - tri.y2) - (c.y - tri.y2) * (tri.x3 - tri.x2) > 0;
 	bool b3 = (c.x - tri.x3) * (tri.y1 - tri.y3) - (c.y - tri.y3) * (tri.x1 - tri.x3) > 0;
 	if ((b1 == b2) && (b2 == b3))
-		return true;
+		return SAW_CD2_RET(CD2_STAT_CT, 0, true);
 	if (Cd2CLs(0, c, LineSeg2(tri.x1, tri.y1, tri.x2, tri.y2)) ||
 		Cd2CLs(0, c, LineSeg2(tri.x2, tri.y2, tri.x3, tri.y3)) ||
 		Cd2CLs(0, c, LineSeg2(tri.x3, tri.y3, tri.x1, tri.y1)))
-		return true;
-	return false;
+		return SAW_CD2_RET(CD2_STAT_CT, 1, true);
+	return SAW_CD2_RET(CD2_STAT_CT, 1, false);
 }
 
 // Collision detection 2d: Circle and Obb
@@ -426,11 +968,11 @@ inline bool Cd2CO(const Circle2 &c, const Obb2 &o) {
 	float hw = fabs(o.halfW), hh = fabs(o.halfH);
 	Project2(c.x, c.y, o.orientX, o.orientY, &px, &py);
 	Project2(o.cx, o.cy, o.orientX, o.orientY, &ox, &oy);
-	return Cd2CA(Circle2(px, py, c.r), Aabb2(ox - hw, oy - hh, ox + hw, oy + hh));
+	return SAW_CD2_RET(CD2_STAT_CO, 0, Cd2CA(Circle2(px, py, c.r), Aabb2(ox - hw, oy - hh, ox + hw, oy + hh)));
 }
 
 // Collision detection 2d: Point and Point
-inline bool Cd2PP(const Point2 &p1, const Point2 &p2) { return p1.x == p2.x && p1.y == p2.y; }
+inline bool Cd2PP(const Point2 &p1, const Point2 &p2) { return SAW_CD2_RET(CD2_STAT_PP, 0, p1.x == p2.x && p1.y == p2.y); }
 
 // Collision detection 2d: Point and Circle
 inline bool Cd2PC(const Point2 &p, const Circle2 &c) { return Cd2CP(c, p); }
@@ -464,28 +1006,28 @@ inline bool Cd2PLs(const Point2 &p, const LineSeg2 &ls) {
 	float sdy = p.y - ls.y1;
 	if (adx < .00001) {
 		float ady = fabs(ls.y2 - ls.y1);
-		return adxp1 < .00001 && fabs(p.y - ls.y2) <= ady && fabs(sdy) <= ady;
+		return SAW_CD2_RET(CD2_STAT_PLS, 0, adxp1 < .00001 && fabs(p.y - ls.y2) <= ady && fabs(sdy) <= ady);
 	}
 	// Test if point is outside of x range
 	if (fabs(p.x - ls.x2) > adx || adxp1 > adx)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_PLS, 1, false);
 	// Calc y on line based upon x, check if that's where the point is
 	float dy = (ls.y2 - ls.y1) / (ls.x2 - ls.x1);
-	return fabs((p.x - ls.x1) * dy - sdy) < .00001;
+	return SAW_CD2_RET(CD2_STAT_PLS, 2, fabs((p.x - ls.x1) * dy - sdy) < .00001);
 }
 
 // Collision detection 2d: Point and Triangle
 inline bool Cd2PT(const Point2 &p, const Triangle2 &tri) {
 	// Triangle with 0 area will always return true when it is likely false
 	if (tri.x1 == tri.x2 && tri.x2 == tri.x3 && tri.y1 == tri.y2 && tri.y2 == tri.y3)
-		return p.x == tri.x1 && p.y == tri.y1;
+		return SAW_CD2_RET(CD2_STAT_PT, 0, p.x == tri.x1 && p.y == tri.y1);
 
 	// Note - these are all > 0 if counter clockwise... but the return condition allows
 	// for either ordering.
 	bool b1 = (p.x - tri.x1) * (tri.y2 - tri.y1) - (p.y - tri.y1) * (tri.x2 - tri.x1) > 0;
 	bool b2 = (p.x - tri.x2) * (tri.y3 - tri.y2) - (p.y - tri.y2) * (tri.x3 - tri.x2) > 0;
 	bool b3 = (p.x - tri.x3) * (tri.y1 - tri.y3) - (p.y - tri.y3) * (tri.x1 - tri.x3) > 0;
-	return ((b1 == b2) && (b2 == b3));
+	return SAW_CD2_RET(CD2_STAT_PT, 1, (b1 == b2) && (b2 == b3));
 }
 
 // Collision detection 2d: Point and Obb
@@ -494,7 +1036,7 @@ inline bool Cd2PO(const Point2 &p, const Obb2 &o) {
 	Unproject2(p.x - o.cx, p.y - o.cy, o.orientX, o.orientY, &px, &py);
 	float hw = fabs(o.halfW);
 	float hh = fabs(o.halfH);
-	return (px >= -hw && px <= hw && py >= -hh && py <= hh);
+	return SAW_CD2_RET(CD2_STAT_PO, 0, px >= -hw && px <= hw && py >= -hh && py <= hh);
 }
 
 // Collision detection 2d: Obb and Point
@@ -509,7 +1051,7 @@ inline bool Cd2OLs(const Obb2 &o, const LineSeg2 &ls) {
 	float hw = fabs(o.halfW), hh = fabs(o.halfH);
 	Unproject2(o.cx, o.cy, o.orientX, o.orientY, &cx, &cy);
 	Aabb2 a(cx - hw, cy - hh, cx + hw, cy + hh);
-	return Cd2ALs(a, ls2);
+	return SAW_CD2_RET(CD2_STAT_OLS, 0, Cd2ALs(a, ls2));
 }
 
 // Collision detection 2d: Obb and Circle
@@ -532,7 +1074,7 @@ inline bool Cd2OO(const Obb2 &o1, const Obb2 &o2) {
 	float halfW = fabs(o2.halfW * ox) + fabs(o2.halfH * oy);
 	float halfH = fabs(o2.halfH * ox) + fabs(o2.halfW * oy);
 	if (cx1 - hw > cx2 + halfW || cx1 + hw < cx2 - halfW || cy1 - hh > cy2 + halfH || cy1 + hh < cy2 - halfH)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_OO, 0, false);
 	// Transform to o2 local space
 	Project2(o1.cx, o1.cy, o2.orientX, -o2.orientY, &cx1, &cy1);
 	Project2(o2.cx, o2.cy, o2.orientX, -o2.orientY, &cx2, &cy2);
@@ -542,9 +1084,9 @@ inline bool Cd2OO(const Obb2 &o1, const Obb2 &o2) {
 	halfW = fabs(o1.halfW * ox) + fabs(o1.halfH * oy);
 	halfH = fabs(o1.halfH * ox) + fabs(o1.halfW * oy);
 	if (cx2 - hw > cx1 + halfW || cx2 + hw < cx1 - halfW || cy2 - hh > cy1 + halfH || cy2 + hh < cy1 - halfH)
-		return false;
+		return SAW_CD2_RET(CD2_STAT_OO, 1, false);
 
-	return true;
+	return SAW_CD2_RET(CD2_STAT_OO, 2, true);
 }
 
 // Collision detection 2d: Obb and Triangle
@@ -558,7 +1100,7 @@ inline bool Cd2OT(const Obb2 &o, const Triangle2 &t) {
 	Unproject2(t.x1, t.y1, o.orientX, o.orientY, &t2.x1, &t2.y1);
 	Unproject2(t.x2, t.y2, o.orientX, o.orientY, &t2.x2, &t2.y2);
 	Unproject2(t.x3, t.y3, o.orientX, o.orientY, &t2.x3, &t2.y3);
-	return Cd2AT(a, t2);
+	return SAW_CD2_RET(CD2_STAT_OT, 0, Cd2AT(a, t2));
 }
 
 // Collision detection 2d: Line Segment and Line Segment
@@ -583,12 +1125,12 @@ inline bool Cd2LsLs(Point2 *pOut, const LineSeg2 &ls1, const LineSeg2 &ls2) {
 		float miny2 = ls2.y1 < ls2.y2 ? ls2.y1 : ls2.y2;
 		float maxy2 = ls2.y1 < ls2.y2 ? ls2.y2 : ls2.y1;
 		if (!(minx1 <= maxx2 && maxx1 >= minx2 && miny1 <= maxy2 && maxy1 >= miny2))
-			return false;
+			return SAW_CD2_RET(CD2_STAT_LSLS, 0, false);
 		if (pOut) {
 			pOut->x = ls1.x1;
 			pOut->y = ls1.y1;
 		}
-		return true;
+		return SAW_CD2_RET(CD2_STAT_LSLS, 0, true);
 	}
 	else if (den != 0) {  // parallel lines if den == 0
 		float iden = 1.0f / den;
@@ -598,10 +1140,10 @@ inline bool Cd2LsLs(Point2 *pOut, const LineSeg2 &ls1, const LineSeg2 &ls2) {
 				pOut->x = ls1.x1 + (ls1.x2 - ls1.x1) * uan * iden;
 				pOut->y = ls1.y1 + (ls1.y2 - ls1.y1) * uan * iden;
 			}
-			return true;
+			return SAW_CD2_RET(CD2_STAT_LSLS, 1, true);
 		}
 	}
-	return false;
+	return SAW_CD2_RET(CD2_STAT_LSLS, 2, false);
 }
 
 // Collision detection 2d: Line Segment and Aabb
@@ -617,12 +1159,12 @@ inline bool Cd2LsP(const LineSeg2 &ls, const Point2 &p) { return Cd2PLs(p, ls);
 inline bool Cd2LsT(const LineSeg2 &ls, const Triangle2 &tri) {
 	// Naive impl.
 	if (Cd2PT(Point2(ls.x1, ls.y1), tri) || Cd2PT(Point2(ls.x2, ls.y2), tri))
-		return true;
+		return SAW_CD2_RET(CD2_STAT_LST, 0, true);
 	if (Cd2LsLs(0, LineSeg2(tri.x1, tri.y1, tri.x2, tri.y2), ls) || 
 		Cd2LsLs(0, LineSeg2(tri.x2, tri.y2, tri.x3, tri.y3), ls) || 
 		Cd2LsLs(0, LineSeg2(tri.x3, tri.y3, tri.x1, tri.y1), ls))
-		return true;
-	return false;
+		return SAW_CD2_RET(CD2_STAT_LST, 1, true);
+	return SAW_CD2_RET(CD2_STAT_LST, 1, false);
 }
 
 // Collision detection 2d: Line Segment and Obb
@@ -646,12 +1188,786 @@ inline bool Cd2TT(const Triangle2 &t1, const Triangle2 &t2) {
 	float t1y[3] = { t1.y1, t1.y2, t1.y3 };
 	float t2x[3] = { t2.x1, t2.x2, t2.x3 };
 	float t2y[3] = { t2.y1, t2.y2, t2.y3 };
-	return Cd2NN(t1x, t1y, 3, t2x, t2y, 3);
+	return SAW_CD2_RET(CD2_STAT_TT, 0, Cd2NN(t1x, t1y, 3, t2x, t2y, 3));
 }
 
 // Collision detection 2d: Triangle and Obb
 inline bool Cd2TO(const Triangle2 &t, const Obb2 &o) { return Cd2OT(o, t); }
 
+// Squared distances the capsule tests build on (defined with the others below)
+inline float Dist2PLs(Point2 p, LineSeg2 ls);
+inline float Dist2PA(Point2 p, Aabb2 a);
+inline float Dist2LsLs(LineSeg2 ls1, LineSeg2 ls2);
+
+// Segment (core) of a capsule
+inline LineSeg2 Capsule2GetSeg(const Capsule2 &k) { return LineSeg2(k.x1, k.y1, k.x2, k.y2); }
+
+// Collision detection 2d: Capsule and Point
+inline bool Cd2CapP(const Capsule2 &k, const Point2 &p) {
+	return SAW_CD2_RET(CD2_STAT_CAPP, 0, Dist2PLs(p, Capsule2GetSeg(k)) <= k.r * k.r);
+}
+
+// Collision detection 2d: Capsule and Aabb
+inline bool Cd2CapA(const Capsule2 &k, const Aabb2 &a) {
+	if (Cd2AP(a, Point2(k.x1, k.y1)))
+		return SAW_CD2_RET(CD2_STAT_CAPA, 0, true);
+	// Otherwise the segment is nearest the aabb along one of its edges
+	LineSeg2 ls = Capsule2GetSeg(k);
+	const LineSeg2 edges[4] = { LineSeg2(a.minX, a.minY, a.maxX, a.minY), LineSeg2(a.maxX, a.minY, a.maxX, a.maxY),
+		LineSeg2(a.maxX, a.maxY, a.minX, a.maxY), LineSeg2(a.minX, a.maxY, a.minX, a.minY) };
+	float d = Dist2LsLs(ls, edges[0]);
+	for (int i = 1; i < 4; i++) {
+		float e = Dist2LsLs(ls, edges[i]);
+		if (e < d)
+			d = e;
+	}
+	return SAW_CD2_RET(CD2_STAT_CAPA, 1, d <= k.r * k.r);
+}
+
+// Collision detection 2d: Capsule and Circle
+inline bool Cd2CapC(const Capsule2 &k, const Circle2 &c) {
+	float r = fabs(k.r) + fabs(c.r);
+	return SAW_CD2_RET(CD2_STAT_CAPC, 0, Dist2PLs(Point2(c.x, c.y), Capsule2GetSeg(k)) <= r * r);
+}
+
+// Collision detection 2d: Capsule and Line Segment
+inline bool Cd2CapLs(const Capsule2 &k, const LineSeg2 &ls) {
+	return SAW_CD2_RET(CD2_STAT_CAPLS, 0, Dist2LsLs(Capsule2GetSeg(k), ls) <= k.r * k.r);
+}
+
+// Collision detection 2d: Capsule and Triangle
+inline bool Cd2CapT(const Capsule2 &k, const Triangle2 &tri) {
+	LineSeg2 ls = Capsule2GetSeg(k);
+	if (Cd2LsT(ls, tri))
+		return SAW_CD2_RET(CD2_STAT_CAPT, 0, true);
+	// Apart, the closest points are an end of the segment and an edge, or a vertex and the segment
+	const LineSeg2 edges[3] = { LineSeg2(tri.x1, tri.y1, tri.x2, tri.y2), LineSeg2(tri.x2, tri.y2, tri.x3, tri.y3),
+		LineSeg2(tri.x3, tri.y3, tri.x1, tri.y1) };
+	float d = Dist2PLs(Point2(tri.x1, tri.y1), ls);
+	for (int i = 0; i < 3; i++) {
+		float e[3] = { Dist2PLs(Point2(ls.x1, ls.y1), edges[i]), Dist2PLs(Point2(ls.x2, ls.y2), edges[i]),
+			Dist2PLs(Point2(edges[i].x2, edges[i].y2), ls) };
+		for (int j = 0; j < 3; j++)
+			if (e[j] < d)
+				d = e[j];
+	}
+	return SAW_CD2_RET(CD2_STAT_CAPT, 1, d <= k.r * k.r);
+}
+
+// Collision detection 2d: Capsule and Obb
+inline bool Cd2CapO(const Capsule2 &k, const Obb2 &o) {
+	// Unproject capsule into local obb space, as Cd2OLs and Cd2PO
+	Capsule2 k2(k.x1 * o.orientX + k.y1 * o.orientY, k.y1 * o.orientX - k.x1 * o.orientY,
+		k.x2 * o.orientX + k.y2 * o.orientY, k.y2 * o.orientX - k.x2 * o.orientY, k.r);
+	float cx = 0, cy = 0;
+	float hw = fabs(o.halfW), hh = fabs(o.halfH);
+	Unproject2(o.cx, o.cy, o.orientX, o.orientY, &cx, &cy);
+	return SAW_CD2_RET(CD2_STAT_CAPO, 0, Cd2CapA(k2, Aabb2(cx - hw, cy - hh, cx + hw, cy + hh)));
+}
+
+// Collision detection 2d: Capsule and Capsule
+inline bool Cd2CapCap(const Capsule2 &k1, const Capsule2 &k2) {
+	float r = fabs(k1.r) + fabs(k2.r);
+	return SAW_CD2_RET(CD2_STAT_CAPCAP, 0, Dist2LsLs(Capsule2GetSeg(k1), Capsule2GetSeg(k2)) <= r * r);
+}
+
+// Collision detection 2d: Point and Capsule
+inline bool Cd2PCap(const Point2 &p, const Capsule2 &k) { return Cd2CapP(k, p); }
+
+// Collision detection 2d: Aabb and Capsule
+inline bool Cd2ACap(const Aabb2 &a, const Capsule2 &k) { return Cd2CapA(k, a); }
+
+// Collision detection 2d: Circle and Capsule
+inline bool Cd2CCap(const Circle2 &c, const Capsule2 &k) { return Cd2CapC(k, c); }
+
+// Collision detection 2d: Line Segment and Capsule
+inline bool Cd2LsCap(const LineSeg2 &ls, const Capsule2 &k) { return Cd2CapLs(k, ls); }
+
+// Collision detection 2d: Triangle and Capsule
+inline bool Cd2TCap(const Triangle2 &tri, const Capsule2 &k) { return Cd2CapT(k, tri); }
+
+// Collision detection 2d: Obb and Capsule
+inline bool Cd2OCap(const Obb2 &o, const Capsule2 &k) { return Cd2CapO(k, o); }
+
+//-----------------------------------------------------------------------------------------------------------
+// GENERIC COLLISION DETECTION
+//-----------------------------------------------------------------------------------------------------------
+
+// One specialization per unordered pair; DEFINED is false for the unregistered order
+template <class A, class B> struct Cd2Dispatch { static const bool DEFINED = false; };
+
+#define SAW_CD2_DISPATCH(A, B, EXPR) \
+	template <> struct Cd2Dispatch<A, B> { \
+		static const bool DEFINED = true; \
+		static bool Test(const A &a, const B &b) { return EXPR; } \
+	}
+SAW_CD2_DISPATCH(Point2, Point2, Cd2PP(a, b));
+SAW_CD2_DISPATCH(Point2, LineSeg2, Cd2PLs(a, b));
+SAW_CD2_DISPATCH(Point2, Triangle2, Cd2PT(a, b));
+SAW_CD2_DISPATCH(Point2, Obb2, Cd2PO(a, b));
+SAW_CD2_DISPATCH(Aabb2, Aabb2, Cd2AA(a, b));
+SAW_CD2_DISPATCH(Aabb2, Point2, Cd2AP(a, b));
+SAW_CD2_DISPATCH(Aabb2, Circle2, Cd2AC(a, b));
+SAW_CD2_DISPATCH(Aabb2, LineSeg2, Cd2ALs(a, b));
+SAW_CD2_DISPATCH(Aabb2, Triangle2, Cd2AT(a, b));
+SAW_CD2_DISPATCH(Aabb2, Obb2, Cd2AO(a, b));
+SAW_CD2_DISPATCH(Circle2, Circle2, Cd2CC(a, b));
+SAW_CD2_DISPATCH(Circle2, LineSeg2, Cd2CLs(0, a, b));
+SAW_CD2_DISPATCH(Circle2, Point2, Cd2CP(a, b));
+SAW_CD2_DISPATCH(Circle2, Triangle2, Cd2CT(a, b));
+SAW_CD2_DISPATCH(Circle2, Obb2, Cd2CO(a, b));
+SAW_CD2_DISPATCH(Obb2, LineSeg2, Cd2OLs(a, b));
+SAW_CD2_DISPATCH(Obb2, Obb2, Cd2OO(a, b));
+SAW_CD2_DISPATCH(Obb2, Triangle2, Cd2OT(a, b));
+SAW_CD2_DISPATCH(LineSeg2, LineSeg2, Cd2LsLs(0, a, b));
+SAW_CD2_DISPATCH(LineSeg2, Triangle2, Cd2LsT(a, b));
+SAW_CD2_DISPATCH(Triangle2, Triangle2, Cd2TT(a, b));
+SAW_CD2_DISPATCH(Capsule2, Point2, Cd2CapP(a, b));
+SAW_CD2_DISPATCH(Capsule2, Aabb2, Cd2CapA(a, b));
+SAW_CD2_DISPATCH(Capsule2, Circle2, Cd2CapC(a, b));
+SAW_CD2_DISPATCH(Capsule2, LineSeg2, Cd2CapLs(a, b));
+SAW_CD2_DISPATCH(Capsule2, Triangle2, Cd2CapT(a, b));
+SAW_CD2_DISPATCH(Capsule2, Obb2, Cd2CapO(a, b));
+SAW_CD2_DISPATCH(Capsule2, Capsule2, Cd2CapCap(a, b));
+#undef SAW_CD2_DISPATCH
+
+template <class A, class B, bool DIRECT = Cd2Dispatch<A, B>::DEFINED> struct Cd2Resolve {
+	static bool Test(const A &a, const B &b) { return Cd2Dispatch<A, B>::Test(a, b); }
+};
+template <class A, class B> struct Cd2Resolve<A, B, false> {
+	static bool Test(const A &a, const B &b) { return Cd2Dispatch<B, A>::Test(b, a); }
+};
+
+// Collision detection 2d: any primitive and any primitive, resolved at compile time
+template <class A, class B> inline bool Cd2(const A &a, const B &b) { return Cd2Resolve<A, B>::Test(a, b); }
+
+// Any primitive, tagged with its type
+struct Shape2 {
+	Prim2Type type;
+	float comps[PRIM2_MAX_COMPS];
+};
+
+template <class T> inline Shape2 Shape2Make(const T &prim) {
+	static_assert(sizeof(T) == Prim2Info<T>::COMPS * sizeof(float), "Primitive must be plain floats");
+	Shape2 s;
+	s.type = Prim2Info<T>::TYPE;
+	memcpy(s.comps, &prim, sizeof(T));
+	for (int i = Prim2Info<T>::COMPS; i < PRIM2_MAX_COMPS; i++)
+		s.comps[i] = 0;
+	return s;
+}
+
+// Primitive of a shape; the shape must be of type T
+template <class T> inline T Shape2Get(const Shape2 &s) {
+	T prim;
+	memcpy(&prim, s.comps, sizeof(T));
+	return prim;
+}
+
+// Call f(prim) with the shape's concrete primitive
+template <class F> inline void Shape2Visit(const Shape2 &s, F &f) {
+	switch (s.type) {
+	case PRIM2_POINT: f(Shape2Get<Point2>(s)); break;
+	case PRIM2_AABB: f(Shape2Get<Aabb2>(s)); break;
+	case PRIM2_OBB: f(Shape2Get<Obb2>(s)); break;
+	case PRIM2_LINESEG: f(Shape2Get<LineSeg2>(s)); break;
+	case PRIM2_TRIANGLE: f(Shape2Get<Triangle2>(s)); break;
+	case PRIM2_CIRCLE: f(Shape2Get<Circle2>(s)); break;
+	case PRIM2_CAPSULE: f(Shape2Get<Capsule2>(s)); break;
+	default: break;
+	}
+}
+
+template <class A> struct Cd2ShapeInner {
+	const A &a;
+	bool ret;
+	template <class B> void operator()(const B &b) { ret = Cd2(a, b); }
+};
+
+struct Cd2ShapeOuter {
+	const Shape2 &b;
+	bool ret;
+	template <class A> void operator()(const A &a) {
+		Cd2ShapeInner<A> inner = { a, false };
+		Shape2Visit(b, inner);
+		ret = inner.ret;
+	}
+};
+
+// Collision detection 2d: any shape and any shape
+inline bool Cd2(const Shape2 &a, const Shape2 &b) {
+	Cd2ShapeOuter outer = { b, false };
+	Shape2Visit(a, outer);
+	return outer.ret;
+}
+
+// Counting sort of shape indices by type: shapes of type t are pOrder[pFirst[t]] to pOrder[pFirst[t + 1] - 1]
+inline void Shape2SortByType(const Shape2 *shapes, size_t n, unsigned int *pOrder, size_t pFirst[PRIM2_COUNT + 1]) {
+	size_t at[PRIM2_COUNT] = { 0 };
+	for (size_t i = 0; i < n; i++)
+		at[shapes[i].type]++;
+	pFirst[0] = 0;
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		pFirst[t + 1] = pFirst[t] + at[t];
+		at[t] = pFirst[t];
+	}
+	for (size_t i = 0; i < n; i++)
+		pOrder[at[shapes[i].type]++] = static_cast<unsigned int>(i);
+}
+
+template <class A, class B> inline void Cd2EachRun(const A &a, const Shape2 *shapes, const unsigned int *order,
+	size_t first, size_t end, bool *pHits) {
+	for (size_t i = first; i < end; i++)
+		pHits[order[i]] = Cd2(a, Shape2Get<B>(shapes[order[i]]));
+}
+
+// Test a against every shape, one inlined loop per type. order/first come from Shape2SortByType.
+// pHits[i] is the result for shapes[i].
+template <class A> inline void Cd2Each(const A &a, const Shape2 *shapes, const unsigned int *order,
+	const size_t first[PRIM2_COUNT + 1], bool *pHits) {
+	Cd2EachRun<A, Point2>(a, shapes, order, first[PRIM2_POINT], first[PRIM2_POINT + 1], pHits);
+	Cd2EachRun<A, Aabb2>(a, shapes, order, first[PRIM2_AABB], first[PRIM2_AABB + 1], pHits);
+	Cd2EachRun<A, Obb2>(a, shapes, order, first[PRIM2_OBB], first[PRIM2_OBB + 1], pHits);
+	Cd2EachRun<A, LineSeg2>(a, shapes, order, first[PRIM2_LINESEG], first[PRIM2_LINESEG + 1], pHits);
+	Cd2EachRun<A, Triangle2>(a, shapes, order, first[PRIM2_TRIANGLE], first[PRIM2_TRIANGLE + 1], pHits);
+	Cd2EachRun<A, Circle2>(a, shapes, order, first[PRIM2_CIRCLE], first[PRIM2_CIRCLE + 1], pHits);
+	Cd2EachRun<A, Capsule2>(a, shapes, order, first[PRIM2_CAPSULE], first[PRIM2_CAPSULE + 1], pHits);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// BATCH POINT TESTS
+//-----------------------------------------------------------------------------------------------------------
+
+// Words of mask for n points
+inline size_t Cd2PointsGetMaskSize(size_t n) { return (n + 31) / 32; }
+
+inline size_t Cd2PointsCountMask(const unsigned int *mask, size_t n) {
+	size_t count = 0;
+	for (size_t w = 0; w < Cd2PointsGetMaskSize(n); w++)
+		for (unsigned int bits = mask[w]; bits; bits &= bits - 1)
+			count++;
+	return count;
+}
+
+// Indices of the set bits of mask (n points) into pOut. Returns the count.
+inline size_t Cd2PointsGetIndices(const unsigned int *mask, size_t n, unsigned int *pOut) {
+	static const unsigned char lowBit[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+	size_t count = 0;
+	for (size_t w = 0; w < Cd2PointsGetMaskSize(n); w++) {
+		for (unsigned int bits = mask[w]; bits; bits &= bits - 1) {
+			// de Bruijn multiply finds the lowest set bit
+			pOut[count++] = static_cast<unsigned int>(w * 32) + lowBit[((bits & (0u - bits)) * 0x077CB531u) >> 27];
+		}
+	}
+	return count;
+}
+
+// Per-shape point tests for Cd2PointsRun. TestN returns N results as bits (as _mm_movemask_ps).
+struct Cd2PointsAabb {
+	Aabb2 a;
+	bool Test(float x, float y) const { return x >= a.minX && x <= a.maxX && y >= a.minY && y <= a.maxY; }
+#ifdef SAW_GEOM_SSE2
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 inX = _mm_and_ps(_mm_cmpge_ps(x, _mm_set1_ps(a.minX)), _mm_cmple_ps(x, _mm_set1_ps(a.maxX)));
+		__m128 inY = _mm_and_ps(_mm_cmpge_ps(y, _mm_set1_ps(a.minY)), _mm_cmple_ps(y, _mm_set1_ps(a.maxY)));
+		return _mm_movemask_ps(_mm_and_ps(inX, inY));
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 inX = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(a.minX), _CMP_GE_OQ), _mm256_cmp_ps(x, _mm256_set1_ps(a.maxX), _CMP_LE_OQ));
+		__m256 inY = _mm256_and_ps(_mm256_cmp_ps(y, _mm256_set1_ps(a.minY), _CMP_GE_OQ), _mm256_cmp_ps(y, _mm256_set1_ps(a.maxY), _CMP_LE_OQ));
+		return _mm256_movemask_ps(_mm256_and_ps(inX, inY));
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		return _mm512_cmp_ps_mask(x, _mm512_set1_ps(a.minX), _CMP_GE_OQ) & _mm512_cmp_ps_mask(x, _mm512_set1_ps(a.maxX), _CMP_LE_OQ) &
+			_mm512_cmp_ps_mask(y, _mm512_set1_ps(a.minY), _CMP_GE_OQ) & _mm512_cmp_ps_mask(y, _mm512_set1_ps(a.maxY), _CMP_LE_OQ);
+	}
+#endif
+};
+
+struct Cd2PointsObb {
+	Obb2 o;
+	float hw, hh;
+	bool Test(float x, float y) const {
+		float px, py;
+		Unproject2(x - o.cx, y - o.cy, o.orientX, o.orientY, &px, &py);
+		return px >= -hw && px <= hw && py >= -hh && py <= hh;
+	}
+#ifdef SAW_GEOM_SSE2
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 ox = _mm_set1_ps(o.orientX), oy = _mm_set1_ps(o.orientY);
+		__m128 dx = _mm_sub_ps(x, _mm_set1_ps(o.cx)), dy = _mm_sub_ps(y, _mm_set1_ps(o.cy));
+		__m128 px = _mm_add_ps(_mm_mul_ps(dx, ox), _mm_mul_ps(dy, oy));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dy, ox), _mm_mul_ps(dx, oy));
+		__m128 inX = _mm_and_ps(_mm_cmpge_ps(px, _mm_set1_ps(-hw)), _mm_cmple_ps(px, _mm_set1_ps(hw)));
+		__m128 inY = _mm_and_ps(_mm_cmpge_ps(py, _mm_set1_ps(-hh)), _mm_cmple_ps(py, _mm_set1_ps(hh)));
+		return _mm_movemask_ps(_mm_and_ps(inX, inY));
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 ox = _mm256_set1_ps(o.orientX), oy = _mm256_set1_ps(o.orientY);
+		__m256 dx = _mm256_sub_ps(x, _mm256_set1_ps(o.cx)), dy = _mm256_sub_ps(y, _mm256_set1_ps(o.cy));
+		__m256 px = _mm256_add_ps(_mm256_mul_ps(dx, ox), _mm256_mul_ps(dy, oy));
+		__m256 py = _mm256_sub_ps(_mm256_mul_ps(dy, ox), _mm256_mul_ps(dx, oy));
+		__m256 inX = _mm256_and_ps(_mm256_cmp_ps(px, _mm256_set1_ps(-hw), _CMP_GE_OQ), _mm256_cmp_ps(px, _mm256_set1_ps(hw), _CMP_LE_OQ));
+		__m256 inY = _mm256_and_ps(_mm256_cmp_ps(py, _mm256_set1_ps(-hh), _CMP_GE_OQ), _mm256_cmp_ps(py, _mm256_set1_ps(hh), _CMP_LE_OQ));
+		return _mm256_movemask_ps(_mm256_and_ps(inX, inY));
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		__m512 ox = _mm512_set1_ps(o.orientX), oy = _mm512_set1_ps(o.orientY);
+		__m512 dx = _mm512_sub_ps(x, _mm512_set1_ps(o.cx)), dy = _mm512_sub_ps(y, _mm512_set1_ps(o.cy));
+		__m512 px = _mm512_add_ps(_mm512_mul_ps(dx, ox), _mm512_mul_ps(dy, oy));
+		__m512 py = _mm512_sub_ps(_mm512_mul_ps(dy, ox), _mm512_mul_ps(dx, oy));
+		return _mm512_cmp_ps_mask(px, _mm512_set1_ps(-hw), _CMP_GE_OQ) & _mm512_cmp_ps_mask(px, _mm512_set1_ps(hw), _CMP_LE_OQ) &
+			_mm512_cmp_ps_mask(py, _mm512_set1_ps(-hh), _CMP_GE_OQ) & _mm512_cmp_ps_mask(py, _mm512_set1_ps(hh), _CMP_LE_OQ);
+	}
+#endif
+};
+
+struct Cd2PointsTriangle {
+	Triangle2 t;
+	bool Test(float x, float y) const {
+		bool b1 = (x - t.x1) * (t.y2 - t.y1) - (y - t.y1) * (t.x2 - t.x1) > 0;
+		bool b2 = (x - t.x2) * (t.y3 - t.y2) - (y - t.y2) * (t.x3 - t.x2) > 0;
+		bool b3 = (x - t.x3) * (t.y1 - t.y3) - (y - t.y3) * (t.x1 - t.x3) > 0;
+		return (b1 == b2) && (b2 == b3);
+	}
+#ifdef SAW_GEOM_SSE2
+	static __m128 Side4(__m128 x, __m128 y, float x1, float y1, float x2, float y2) {
+		__m128 d = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(x, _mm_set1_ps(x1)), _mm_set1_ps(y2 - y1)),
+			_mm_mul_ps(_mm_sub_ps(y, _mm_set1_ps(y1)), _mm_set1_ps(x2 - x1)));
+		return _mm_cmpgt_ps(d, _mm_setzero_ps());
+	}
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 b1 = Side4(x, y, t.x1, t.y1, t.x2, t.y2);
+		__m128 b2 = Side4(x, y, t.x2, t.y2, t.x3, t.y3);
+		__m128 b3 = Side4(x, y, t.x3, t.y3, t.x1, t.y1);
+		return _mm_movemask_ps(_mm_or_ps(_mm_xor_ps(b1, b2), _mm_xor_ps(b2, b3))) ^ 0xf;
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 static __m256 Side8(__m256 x, __m256 y, float x1, float y1, float x2, float y2) {
+		__m256 d = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(x1)), _mm256_set1_ps(y2 - y1)),
+			_mm256_mul_ps(_mm256_sub_ps(y, _mm256_set1_ps(y1)), _mm256_set1_ps(x2 - x1)));
+		return _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GT_OQ);
+	}
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 b1 = Side8(x, y, t.x1, t.y1, t.x2, t.y2);
+		__m256 b2 = Side8(x, y, t.x2, t.y2, t.x3, t.y3);
+		__m256 b3 = Side8(x, y, t.x3, t.y3, t.x1, t.y1);
+		return _mm256_movemask_ps(_mm256_or_ps(_mm256_xor_ps(b1, b2), _mm256_xor_ps(b2, b3))) ^ 0xff;
+	}
+	SAW_GEOM_TARGET_AVX512 static unsigned int Side16(__m512 x, __m512 y, float x1, float y1, float x2, float y2) {
+		__m512 d = _mm512_sub_ps(_mm512_mul_ps(_mm512_sub_ps(x, _mm512_set1_ps(x1)), _mm512_set1_ps(y2 - y1)),
+			_mm512_mul_ps(_mm512_sub_ps(y, _mm512_set1_ps(y1)), _mm512_set1_ps(x2 - x1)));
+		return _mm512_cmp_ps_mask(d, _mm512_setzero_ps(), _CMP_GT_OQ);
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		unsigned int b1 = Side16(x, y, t.x1, t.y1, t.x2, t.y2);
+		unsigned int b2 = Side16(x, y, t.x2, t.y2, t.x3, t.y3);
+		unsigned int b3 = Side16(x, y, t.x3, t.y3, t.x1, t.y1);
+		return ((b1 ^ b2) | (b2 ^ b3)) ^ 0xffff;
+	}
+#endif
+};
+
+struct Cd2PointsCircle {
+	Circle2 c;
+	bool Test(float x, float y) const {
+		float dx = c.x - x, dy = c.y - y;
+		return dx * dx + dy * dy <= c.r * c.r;
+	}
+#ifdef SAW_GEOM_SSE2
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 dx = _mm_sub_ps(_mm_set1_ps(c.x), x), dy = _mm_sub_ps(_mm_set1_ps(c.y), y);
+		__m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		return _mm_movemask_ps(_mm_cmple_ps(d, _mm_set1_ps(c.r * c.r)));
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 dx = _mm256_sub_ps(_mm256_set1_ps(c.x), x), dy = _mm256_sub_ps(_mm256_set1_ps(c.y), y);
+		__m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+		return _mm256_movemask_ps(_mm256_cmp_ps(d, _mm256_set1_ps(c.r * c.r), _CMP_LE_OQ));
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		__m512 dx = _mm512_sub_ps(_mm512_set1_ps(c.x), x), dy = _mm512_sub_ps(_mm512_set1_ps(c.y), y);
+		__m512 d = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+		return _mm512_cmp_ps_mask(d, _mm512_set1_ps(c.r * c.r), _CMP_LE_OQ);
+	}
+#endif
+};
+
+// Closest point on the segment as Dist2PLs: clamped below 0 by t, and the end itself past 1
+struct Cd2PointsCapsule {
+	LineSeg2 ls;
+	float dx, dy, line2, r2;
+	bool Test(float x, float y) const { return Dist2PLs(Point2(x, y), ls) <= r2; }
+#ifdef SAW_GEOM_SSE2
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 vdx = _mm_set1_ps(dx), vdy = _mm_set1_ps(dy);
+		__m128 ex = _mm_sub_ps(x, _mm_set1_ps(ls.x1)), ey = _mm_sub_ps(y, _mm_set1_ps(ls.y1));
+		__m128 t = _mm_div_ps(_mm_add_ps(_mm_mul_ps(ex, vdx), _mm_mul_ps(ey, vdy)), _mm_set1_ps(line2));
+		__m128 over = _mm_cmpgt_ps(t, _mm_set1_ps(1));
+		t = _mm_max_ps(t, _mm_setzero_ps());
+		__m128 nx = _mm_add_ps(_mm_set1_ps(ls.x1), _mm_mul_ps(t, vdx)), ny = _mm_add_ps(_mm_set1_ps(ls.y1), _mm_mul_ps(t, vdy));
+		nx = _mm_or_ps(_mm_and_ps(over, _mm_set1_ps(ls.x2)), _mm_andnot_ps(over, nx));
+		ny = _mm_or_ps(_mm_and_ps(over, _mm_set1_ps(ls.y2)), _mm_andnot_ps(over, ny));
+		ex = _mm_sub_ps(x, nx);
+		ey = _mm_sub_ps(y, ny);
+		return _mm_movemask_ps(_mm_cmple_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_set1_ps(r2)));
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 vdx = _mm256_set1_ps(dx), vdy = _mm256_set1_ps(dy);
+		__m256 ex = _mm256_sub_ps(x, _mm256_set1_ps(ls.x1)), ey = _mm256_sub_ps(y, _mm256_set1_ps(ls.y1));
+		__m256 t = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(ex, vdx), _mm256_mul_ps(ey, vdy)), _mm256_set1_ps(line2));
+		__m256 over = _mm256_cmp_ps(t, _mm256_set1_ps(1), _CMP_GT_OQ);
+		t = _mm256_max_ps(t, _mm256_setzero_ps());
+		__m256 nx = _mm256_add_ps(_mm256_set1_ps(ls.x1), _mm256_mul_ps(t, vdx)), ny = _mm256_add_ps(_mm256_set1_ps(ls.y1), _mm256_mul_ps(t, vdy));
+		ex = _mm256_sub_ps(x, _mm256_blendv_ps(nx, _mm256_set1_ps(ls.x2), over));
+		ey = _mm256_sub_ps(y, _mm256_blendv_ps(ny, _mm256_set1_ps(ls.y2), over));
+		return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)), _mm256_set1_ps(r2), _CMP_LE_OQ));
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		__m512 vdx = _mm512_set1_ps(dx), vdy = _mm512_set1_ps(dy);
+		__m512 ex = _mm512_sub_ps(x, _mm512_set1_ps(ls.x1)), ey = _mm512_sub_ps(y, _mm512_set1_ps(ls.y1));
+		__m512 t = _mm512_div_ps(_mm512_add_ps(_mm512_mul_ps(ex, vdx), _mm512_mul_ps(ey, vdy)), _mm512_set1_ps(line2));
+		__mmask16 over = _mm512_cmp_ps_mask(t, _mm512_set1_ps(1), _CMP_GT_OQ);
+		t = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(t, _mm512_setzero_ps(), _CMP_GT_OQ), t);
+		__m512 nx = _mm512_add_ps(_mm512_set1_ps(ls.x1), _mm512_mul_ps(t, vdx)), ny = _mm512_add_ps(_mm512_set1_ps(ls.y1), _mm512_mul_ps(t, vdy));
+		ex = _mm512_sub_ps(x, _mm512_mask_blend_ps(over, nx, _mm512_set1_ps(ls.x2)));
+		ey = _mm512_sub_ps(y, _mm512_mask_blend_ps(over, ny, _mm512_set1_ps(ls.y2)));
+		return _mm512_cmp_ps_mask(_mm512_add_ps(_mm512_mul_ps(ex, ex), _mm512_mul_ps(ey, ey)), _mm512_set1_ps(r2), _CMP_LE_OQ);
+	}
+#endif
+};
+
+// Up to 16 separating axes of a convex polygon with its extent on each, as Cd2NN
+struct Cd2PointsPolyAxes {
+	float vecX[16], vecY[16], mn[16], mx[16];
+	int numAxes;
+	bool Test(float x, float y) const {
+		for (int e = 0; e < numAxes; e++) {
+			float d = x * vecX[e] + y * vecY[e];
+			if (!(d >= mn[e] && d <= mx[e]))
+				return false;
+		}
+		return true;
+	}
+#ifdef SAW_GEOM_SSE2
+	unsigned int Test4(__m128 x, __m128 y) const {
+		__m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int e = 0; e < numAxes; e++) {
+			__m128 d = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(vecX[e])), _mm_mul_ps(y, _mm_set1_ps(vecY[e])));
+			in = _mm_and_ps(in, _mm_and_ps(_mm_cmpge_ps(d, _mm_set1_ps(mn[e])), _mm_cmple_ps(d, _mm_set1_ps(mx[e]))));
+		}
+		return _mm_movemask_ps(in);
+	}
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 unsigned int Test8(__m256 x, __m256 y) const {
+		__m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int e = 0; e < numAxes; e++) {
+			__m256 d = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(vecX[e])), _mm256_mul_ps(y, _mm256_set1_ps(vecY[e])));
+			in = _mm256_and_ps(in, _mm256_and_ps(_mm256_cmp_ps(d, _mm256_set1_ps(mn[e]), _CMP_GE_OQ), _mm256_cmp_ps(d, _mm256_set1_ps(mx[e]), _CMP_LE_OQ)));
+		}
+		return _mm256_movemask_ps(in);
+	}
+	SAW_GEOM_TARGET_AVX512 unsigned int Test16(__m512 x, __m512 y) const {
+		unsigned int in = 0xffff;
+		for (int e = 0; e < numAxes; e++) {
+			__m512 d = _mm512_add_ps(_mm512_mul_ps(x, _mm512_set1_ps(vecX[e])), _mm512_mul_ps(y, _mm512_set1_ps(vecY[e])));
+			in &= _mm512_cmp_ps_mask(d, _mm512_set1_ps(mn[e]), _CMP_GE_OQ) & _mm512_cmp_ps_mask(d, _mm512_set1_ps(mx[e]), _CMP_LE_OQ);
+		}
+		return in;
+	}
+#endif
+};
+
+// Put the results of points i to i + width - 1 in the mask: set, or with intersect clear the ones outside
+inline void Cd2PointsStore(unsigned int *pMask, size_t i, unsigned int bits, unsigned int lanes, bool intersect) {
+	if (intersect)
+		pMask[i >> 5] &= ~((~bits & lanes) << (i & 31));
+	else
+		pMask[i >> 5] |= bits << (i & 31);
+}
+
+#ifdef SAW_GEOM_DISPATCH
+// Groups of 8 and 16 points; return the number of points done
+template <class T> SAW_GEOM_TARGET_AVX2 size_t Cd2PointsRunAvx2(const T &test, const float *px, const float *py, size_t n,
+	unsigned int *pMask, bool intersect) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+		Cd2PointsStore(pMask, i, test.Test8(_mm256_loadu_ps(px + i), _mm256_loadu_ps(py + i)), 0xff, intersect);
+	return i;
+}
+
+template <class T> SAW_GEOM_TARGET_AVX512 size_t Cd2PointsRunAvx512(const T &test, const float *px, const float *py, size_t n,
+	unsigned int *pMask, bool intersect) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16)
+		Cd2PointsStore(pMask, i, test.Test16(_mm512_loadu_ps(px + i), _mm512_loadu_ps(py + i)), 0xffff, intersect);
+	return i;
+}
+#endif
+
+// Test n points with the widest kernel the cpu level allows. The mask is cleared first unless intersect.
+template <class T> inline void Cd2PointsRun(const T &test, const float *px, const float *py, size_t n, unsigned int *pMask,
+	bool intersect = false) {
+	if (!intersect)
+		memset(pMask, 0, Cd2PointsGetMaskSize(n) * sizeof(unsigned int));
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	Cd2CpuLevel level = Cd2GetCpuLevel();
+#	ifdef SAW_GEOM_DISPATCH
+	if (level >= CD2_CPU_AVX512)
+		i = Cd2PointsRunAvx512(test, px, py, n, pMask, intersect);
+	else if (level >= CD2_CPU_AVX2)
+		i = Cd2PointsRunAvx2(test, px, py, n, pMask, intersect);
+#	endif
+	for (; level >= CD2_CPU_SSE2 && i + 4 <= n; i += 4)
+		Cd2PointsStore(pMask, i, test.Test4(_mm_loadu_ps(px + i), _mm_loadu_ps(py + i)), 0xf, intersect);
+#endif
+	for (; i < n; i++)
+		Cd2PointsStore(pMask, i, test.Test(px[i], py[i]), 1, intersect);
+}
+
+// Batch point tests: n points against one shape into pOutMask (Cd2PointsGetMaskSize(n) words).
+// Return the number of points inside.
+inline size_t Cd2PointsA(const float *px, const float *py, size_t n, const Aabb2 &a, unsigned int *pOutMask) {
+	Cd2PointsAabb test = { a };
+	Cd2PointsRun(test, px, py, n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+inline size_t Cd2PointsO(const float *px, const float *py, size_t n, const Obb2 &o, unsigned int *pOutMask) {
+	Cd2PointsObb test = { o, fabs(o.halfW), fabs(o.halfH) };
+	Cd2PointsRun(test, px, py, n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+inline size_t Cd2PointsT(const float *px, const float *py, size_t n, const Triangle2 &t, unsigned int *pOutMask) {
+	// Triangle with 0 area is a point (as Cd2PT)
+	if (t.x1 == t.x2 && t.x2 == t.x3 && t.y1 == t.y2 && t.y2 == t.y3)
+		return Cd2PointsA(px, py, n, Aabb2(t.x1, t.y1, t.x1, t.y1), pOutMask);
+	Cd2PointsTriangle test = { t };
+	Cd2PointsRun(test, px, py, n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+inline size_t Cd2PointsC(const float *px, const float *py, size_t n, const Circle2 &c, unsigned int *pOutMask) {
+	Cd2PointsCircle test = { c };
+	Cd2PointsRun(test, px, py, n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+inline size_t Cd2PointsCap(const float *px, const float *py, size_t n, const Capsule2 &k, unsigned int *pOutMask) {
+	// Capsule with a 0 length segment is a circle (as Dist2PLs)
+	float line2 = (k.x1 - k.x2) * (k.x1 - k.x2) + (k.y1 - k.y2) * (k.y1 - k.y2);
+	if (line2 == 0)
+		return Cd2PointsC(px, py, n, Circle2(k.x1, k.y1, k.r), pOutMask);
+	Cd2PointsCapsule test = { Capsule2GetSeg(k), k.x2 - k.x1, k.y2 - k.y1, line2, k.r * k.r };
+	Cd2PointsRun(test, px, py, n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+// Convex polygon of polyN vertices. Edges are taken 16 at a time, each group after the first intersected with the mask.
+inline size_t Cd2PointsN(const float *px, const float *py, size_t n, const float *polyX, const float *polyY, int polyN,
+	unsigned int *pOutMask) {
+	const float BIG_FLT = 1E+37f;
+	Cd2PointsPolyAxes axes;
+	if (polyN <= 0) {
+		axes.numAxes = 0;
+		Cd2PointsRun(axes, px, py, n, pOutMask);
+	}
+	for (int first = 0; first < polyN; first += 16) {
+		axes.numAxes = polyN - first < 16 ? polyN - first : 16;
+		for (int e = 0; e < axes.numAxes; e++) {
+			int j = first + e, lastJ = j == 0 ? polyN - 1 : j - 1;
+			axes.vecX[e] = polyY[lastJ] - polyY[j];
+			axes.vecY[e] = polyX[j] - polyX[lastJ];
+			axes.mn[e] = BIG_FLT;
+			axes.mx[e] = -BIG_FLT;
+			for (int l = 0; l < polyN; l++) {
+				float d = polyX[l] * axes.vecX[e] + polyY[l] * axes.vecY[e];
+				if (d < axes.mn[e])
+					axes.mn[e] = d;
+				if (d > axes.mx[e])
+					axes.mx[e] = d;
+			}
+		}
+		Cd2PointsRun(axes, px, py, n, pOutMask, first > 0);
+	}
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// BATCH OBB TESTS
+//-----------------------------------------------------------------------------------------------------------
+
+// Obbs for Cd2ObbsRun: comps (cx, cy, orientX, orientY, halfW, halfH arrays) from index i, or one obb in
+// every lane when comps is 0
+struct Cd2ObbsSource {
+	const float *const *comps;
+	float one[6];
+	float Get(int k, size_t i) const { return comps ? comps[k][i] : one[k]; }
+#ifdef SAW_GEOM_SSE2
+	__m128 Load4(int k, size_t i) const { return comps ? _mm_loadu_ps(comps[k] + i) : _mm_set1_ps(one[k]); }
+#endif
+#ifdef SAW_GEOM_DISPATCH
+	SAW_GEOM_TARGET_AVX2 __m256 Load8(int k, size_t i) const { return comps ? _mm256_loadu_ps(comps[k] + i) : _mm256_set1_ps(one[k]); }
+	SAW_GEOM_TARGET_AVX512 __m512 Load16(int k, size_t i) const { return comps ? _mm512_loadu_ps(comps[k] + i) : _mm512_set1_ps(one[k]); }
+#endif
+};
+
+inline Cd2ObbsSource Cd2ObbsMakeSource(const float *const comps[6]) {
+	Cd2ObbsSource src = { comps, { 0, 0, 0, 0, 0, 0 } };
+	return src;
+}
+
+inline Cd2ObbsSource Cd2ObbsMakeSource(const Obb2 &o) {
+	Cd2ObbsSource src = { 0, { o.cx, o.cy, o.orientX, o.orientY, o.halfW, o.halfH } };
+	return src;
+}
+
+// Whether b is off a on one of a's axes, the first half of Cd2OO (same operations, so the same results).
+// Components as Cd2ObbsSource.
+inline bool Cd2ObbsSep(const float a[6], const float b[6]) {
+	float cax = a[0] * a[2] + a[1] * a[3], cay = a[1] * a[2] - a[0] * a[3];
+	float cbx = b[0] * a[2] + b[1] * a[3], cby = b[1] * a[2] - b[0] * a[3];
+	float ox = b[2] * a[2] + b[3] * a[3], oy = b[3] * a[2] - b[2] * a[3];
+	float hw = fabs(a[4]), hh = fabs(a[5]);
+	float extW = fabs(b[4] * ox) + fabs(b[5] * oy), extH = fabs(b[5] * ox) + fabs(b[4] * oy);
+	return cax - hw > cbx + extW || cax + hw < cbx - extW || cay - hh > cby + extH || cay + hh < cby - extH;
+}
+
+#ifdef SAW_GEOM_SSE2
+inline __m128 Cd2ObbsSep4(const __m128 a[6], const __m128 b[6]) {
+	__m128 cax = _mm_add_ps(_mm_mul_ps(a[0], a[2]), _mm_mul_ps(a[1], a[3])), cay = _mm_sub_ps(_mm_mul_ps(a[1], a[2]), _mm_mul_ps(a[0], a[3]));
+	__m128 cbx = _mm_add_ps(_mm_mul_ps(b[0], a[2]), _mm_mul_ps(b[1], a[3])), cby = _mm_sub_ps(_mm_mul_ps(b[1], a[2]), _mm_mul_ps(b[0], a[3]));
+	__m128 ox = _mm_add_ps(_mm_mul_ps(b[2], a[2]), _mm_mul_ps(b[3], a[3])), oy = _mm_sub_ps(_mm_mul_ps(b[3], a[2]), _mm_mul_ps(b[2], a[3]));
+	__m128 hw = CalcAabb2Abs4(a[4]), hh = CalcAabb2Abs4(a[5]);
+	__m128 extW = _mm_add_ps(CalcAabb2Abs4(_mm_mul_ps(b[4], ox)), CalcAabb2Abs4(_mm_mul_ps(b[5], oy)));
+	__m128 extH = _mm_add_ps(CalcAabb2Abs4(_mm_mul_ps(b[5], ox)), CalcAabb2Abs4(_mm_mul_ps(b[4], oy)));
+	__m128 sepX = _mm_or_ps(_mm_cmpgt_ps(_mm_sub_ps(cax, hw), _mm_add_ps(cbx, extW)), _mm_cmplt_ps(_mm_add_ps(cax, hw), _mm_sub_ps(cbx, extW)));
+	__m128 sepY = _mm_or_ps(_mm_cmpgt_ps(_mm_sub_ps(cay, hh), _mm_add_ps(cby, extH)), _mm_cmplt_ps(_mm_add_ps(cay, hh), _mm_sub_ps(cby, extH)));
+	return _mm_or_ps(sepX, sepY);
+}
+#endif
+
+#ifdef SAW_GEOM_DISPATCH
+SAW_GEOM_TARGET_AVX2 inline __m256 Cd2ObbsAbs8(__m256 v) {
+	return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
+SAW_GEOM_TARGET_AVX2 inline __m256 Cd2ObbsSep8(const __m256 a[6], const __m256 b[6]) {
+	__m256 cax = _mm256_add_ps(_mm256_mul_ps(a[0], a[2]), _mm256_mul_ps(a[1], a[3])), cay = _mm256_sub_ps(_mm256_mul_ps(a[1], a[2]), _mm256_mul_ps(a[0], a[3]));
+	__m256 cbx = _mm256_add_ps(_mm256_mul_ps(b[0], a[2]), _mm256_mul_ps(b[1], a[3])), cby = _mm256_sub_ps(_mm256_mul_ps(b[1], a[2]), _mm256_mul_ps(b[0], a[3]));
+	__m256 ox = _mm256_add_ps(_mm256_mul_ps(b[2], a[2]), _mm256_mul_ps(b[3], a[3])), oy = _mm256_sub_ps(_mm256_mul_ps(b[3], a[2]), _mm256_mul_ps(b[2], a[3]));
+	__m256 hw = Cd2ObbsAbs8(a[4]), hh = Cd2ObbsAbs8(a[5]);
+	__m256 extW = _mm256_add_ps(Cd2ObbsAbs8(_mm256_mul_ps(b[4], ox)), Cd2ObbsAbs8(_mm256_mul_ps(b[5], oy)));
+	__m256 extH = _mm256_add_ps(Cd2ObbsAbs8(_mm256_mul_ps(b[5], ox)), Cd2ObbsAbs8(_mm256_mul_ps(b[4], oy)));
+	__m256 sepX = _mm256_or_ps(_mm256_cmp_ps(_mm256_sub_ps(cax, hw), _mm256_add_ps(cbx, extW), _CMP_GT_OQ),
+		_mm256_cmp_ps(_mm256_add_ps(cax, hw), _mm256_sub_ps(cbx, extW), _CMP_LT_OQ));
+	__m256 sepY = _mm256_or_ps(_mm256_cmp_ps(_mm256_sub_ps(cay, hh), _mm256_add_ps(cby, extH), _CMP_GT_OQ),
+		_mm256_cmp_ps(_mm256_add_ps(cay, hh), _mm256_sub_ps(cby, extH), _CMP_LT_OQ));
+	return _mm256_or_ps(sepX, sepY);
+}
+
+SAW_GEOM_TARGET_AVX512 inline __m512 Cd2ObbsAbs16(__m512 v) {
+	return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+}
+
+SAW_GEOM_TARGET_AVX512 inline __mmask16 Cd2ObbsSep16(const __m512 a[6], const __m512 b[6]) {
+	__m512 cax = _mm512_add_ps(_mm512_mul_ps(a[0], a[2]), _mm512_mul_ps(a[1], a[3])), cay = _mm512_sub_ps(_mm512_mul_ps(a[1], a[2]), _mm512_mul_ps(a[0], a[3]));
+	__m512 cbx = _mm512_add_ps(_mm512_mul_ps(b[0], a[2]), _mm512_mul_ps(b[1], a[3])), cby = _mm512_sub_ps(_mm512_mul_ps(b[1], a[2]), _mm512_mul_ps(b[0], a[3]));
+	__m512 ox = _mm512_add_ps(_mm512_mul_ps(b[2], a[2]), _mm512_mul_ps(b[3], a[3])), oy = _mm512_sub_ps(_mm512_mul_ps(b[3], a[2]), _mm512_mul_ps(b[2], a[3]));
+	__m512 hw = Cd2ObbsAbs16(a[4]), hh = Cd2ObbsAbs16(a[5]);
+	__m512 extW = _mm512_add_ps(Cd2ObbsAbs16(_mm512_mul_ps(b[4], ox)), Cd2ObbsAbs16(_mm512_mul_ps(b[5], oy)));
+	__m512 extH = _mm512_add_ps(Cd2ObbsAbs16(_mm512_mul_ps(b[5], ox)), Cd2ObbsAbs16(_mm512_mul_ps(b[4], oy)));
+	return _mm512_cmp_ps_mask(_mm512_sub_ps(cax, hw), _mm512_add_ps(cbx, extW), _CMP_GT_OQ) |
+		_mm512_cmp_ps_mask(_mm512_add_ps(cax, hw), _mm512_sub_ps(cbx, extW), _CMP_LT_OQ) |
+		_mm512_cmp_ps_mask(_mm512_sub_ps(cay, hh), _mm512_add_ps(cby, extH), _CMP_GT_OQ) |
+		_mm512_cmp_ps_mask(_mm512_add_ps(cay, hh), _mm512_sub_ps(cby, extH), _CMP_LT_OQ);
+}
+
+// Groups of 8 and 16 pairs; return the number of pairs done
+SAW_GEOM_TARGET_AVX2 inline size_t Cd2ObbsRunAvx2(const Cd2ObbsSource &src1, const Cd2ObbsSource &src2, size_t n, unsigned int *pMask) {
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256 a[6], b[6];
+		for (int k = 0; k < 6; k++) {
+			a[k] = src1.Load8(k, i);
+			b[k] = src2.Load8(k, i);
+		}
+		Cd2PointsStore(pMask, i, ~_mm256_movemask_ps(_mm256_or_ps(Cd2ObbsSep8(a, b), Cd2ObbsSep8(b, a))) & 0xff, 0xff, false);
+	}
+	return i;
+}
+
+SAW_GEOM_TARGET_AVX512 inline size_t Cd2ObbsRunAvx512(const Cd2ObbsSource &src1, const Cd2ObbsSource &src2, size_t n, unsigned int *pMask) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m512 a[6], b[6];
+		for (int k = 0; k < 6; k++) {
+			a[k] = src1.Load16(k, i);
+			b[k] = src2.Load16(k, i);
+		}
+		Cd2PointsStore(pMask, i, ~(Cd2ObbsSep16(a, b) | Cd2ObbsSep16(b, a)) & 0xffff, 0xffff, false);
+	}
+	return i;
+}
+#endif
+
+// Test pairs 0 to n - 1 of src1 and src2 into pMask (cleared first), with the widest kernel the cpu level allows
+inline void Cd2ObbsRun(const Cd2ObbsSource &src1, const Cd2ObbsSource &src2, size_t n, unsigned int *pMask) {
+	memset(pMask, 0, Cd2PointsGetMaskSize(n) * sizeof(unsigned int));
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	Cd2CpuLevel level = Cd2GetCpuLevel();
+#	ifdef SAW_GEOM_DISPATCH
+	if (level >= CD2_CPU_AVX512)
+		i = Cd2ObbsRunAvx512(src1, src2, n, pMask);
+	else if (level >= CD2_CPU_AVX2)
+		i = Cd2ObbsRunAvx2(src1, src2, n, pMask);
+#	endif
+	for (; level >= CD2_CPU_SSE2 && i + 4 <= n; i += 4) {
+		__m128 a[6], b[6];
+		for (int k = 0; k < 6; k++) {
+			a[k] = src1.Load4(k, i);
+			b[k] = src2.Load4(k, i);
+		}
+		Cd2PointsStore(pMask, i, ~_mm_movemask_ps(_mm_or_ps(Cd2ObbsSep4(a, b), Cd2ObbsSep4(b, a))) & 0xf, 0xf, false);
+	}
+#endif
+	for (; i < n; i++) {
+		float a[6], b[6];
+		for (int k = 0; k < 6; k++) {
+			a[k] = src1.Get(k, i);
+			b[k] = src2.Get(k, i);
+		}
+		Cd2PointsStore(pMask, i, !Cd2ObbsSep(a, b) && !Cd2ObbsSep(b, a), 1, false);
+	}
+}
+
+// Batch obb tests: n obbs (comps as CalcAabb2Soa) against one obb into pOutMask (Cd2PointsGetMaskSize(n)
+// words), bit i equal to Cd2OO(obb i, o). Return the number that overlap.
+inline size_t Cd2ObbsO(const float *const comps[6], size_t n, const Obb2 &o, unsigned int *pOutMask) {
+	Cd2ObbsRun(Cd2ObbsMakeSource(comps), Cd2ObbsMakeSource(o), n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
+// Pairs: bit i equal to Cd2OO(obb i of comps1, obb i of comps2)
+inline size_t Cd2ObbsObbs(const float *const comps1[6], const float *const comps2[6], size_t n, unsigned int *pOutMask) {
+	Cd2ObbsRun(Cd2ObbsMakeSource(comps1), Cd2ObbsMakeSource(comps2), n, pOutMask);
+	return Cd2PointsCountMask(pOutMask, n);
+}
+
 //-----------------------------------------------------------------------------------------------------------
 // DISTANCE SQUARED CALCULATION
 //-----------------------------------------------------------------------------------------------------------
@@ -698,6 +2014,280 @@ inline float Dist2CP(Circle2 c, Point2 p) { return Dist2PC(p, c); }
 // Distance 2d squared: Line Segment and Point
 inline float Dist2LsP(LineSeg2 ls, Point2 p) { return Dist2PLs(p, ls); }
 
+// Distance 2d squared: Point and Aabb (0 inside)
+inline float Dist2PA(Point2 p, Aabb2 a) {
+	float dx = p.x < a.minX ? a.minX - p.x : (p.x > a.maxX ? p.x - a.maxX : 0);
+	float dy = p.y < a.minY ? a.minY - p.y : (p.y > a.maxY ? p.y - a.maxY : 0);
+	return dx * dx + dy * dy;
+}
+
+// Distance 2d squared: Aabb and Point
+inline float Dist2AP(Aabb2 a, Point2 p) { return Dist2PA(p, a); }
+
+// Distance 2d squared: Line Segment and Line Segment (0 if they meet)
+inline float Dist2LsLs(LineSeg2 ls1, LineSeg2 ls2) {
+	if (Cd2LsLs(0, ls1, ls2))
+		return 0;
+	// Apart, the closest points include an end of one of the segments
+	float d[4] = { Dist2PLs(Point2(ls1.x1, ls1.y1), ls2), Dist2PLs(Point2(ls1.x2, ls1.y2), ls2),
+		Dist2PLs(Point2(ls2.x1, ls2.y1), ls1), Dist2PLs(Point2(ls2.x2, ls2.y2), ls1) };
+	float m = d[0];
+	for (int i = 1; i < 4; i++)
+		if (d[i] < m)
+			m = d[i];
+	return m;
+}
+
+// Distance 2d squared: Point and Capsule
+inline float Dist2PCap(Point2 p, Capsule2 k) {
+	return Dist2PLs(p, Capsule2GetSeg(k)) - k.r * k.r;
+}
+
+// Distance 2d squared: Circle and Capsule
+inline float Dist2CCap(Circle2 c, Capsule2 k) {
+	return Dist2PLs(Point2(c.x, c.y), Capsule2GetSeg(k)) - c.r * c.r - k.r * k.r;
+}
+
+// Distance 2d squared: Line Segment and Capsule
+inline float Dist2LsCap(LineSeg2 ls, Capsule2 k) {
+	return Dist2LsLs(ls, Capsule2GetSeg(k)) - k.r * k.r;
+}
+
+// Distance 2d squared: Capsule and Capsule
+inline float Dist2CapCap(Capsule2 k1, Capsule2 k2) {
+	return Dist2LsLs(Capsule2GetSeg(k1), Capsule2GetSeg(k2)) - k1.r * k1.r - k2.r * k2.r;
+}
+
+// Distance 2d squared: Capsule and Point
+inline float Dist2CapP(Capsule2 k, Point2 p) { return Dist2PCap(p, k); }
+
+// Distance 2d squared: Capsule and Circle
+inline float Dist2CapC(Capsule2 k, Circle2 c) { return Dist2CCap(c, k); }
+
+// Distance 2d squared: Capsule and Line Segment
+inline float Dist2CapLs(Capsule2 k, LineSeg2 ls) { return Dist2LsCap(ls, k); }
+
+// Whether x, y is inside (or on) the convex polygon px, py of n vertices, in either winding. False if every
+// edge is collinear with it (a polygon of no area), which is left to the edge distances.
+inline bool Dist2NNHas(const float *px, const float *py, int n, float x, float y) {
+	bool pos = false, neg = false;
+	for (int i = 0, j = n - 1; i < n; j = i++) {
+		float z = (px[i] - px[j]) * (y - py[j]) - (py[i] - py[j]) * (x - px[j]);
+		pos |= z > 0;
+		neg |= z < 0;
+	}
+	return pos != neg;
+}
+
+// Distance 2d squared: convex polygon and convex polygon, each 1 (point), 2 (segment) or more vertices.
+// 0 if they overlap.
+inline float Dist2NN(const float *px1, const float *py1, int n1, const float *px2, const float *py2, int n2) {
+	if ((n2 > 2 && Dist2NNHas(px2, py2, n2, px1[0], py1[0])) || (n1 > 2 && Dist2NNHas(px1, py1, n1, px2[0], py2[0])))
+		return 0;
+	// Otherwise the nearest points are on the edges (a point or segment is its own single edge)
+	int e1 = n1 > 2 ? n1 : 1, e2 = n2 > 2 ? n2 : 1;
+	float d = 0;
+	for (int i = 0; i < e1; i++) {
+		LineSeg2 ls1(px1[i], py1[i], px1[(i + 1) % n1], py1[(i + 1) % n1]);
+		for (int j = 0; j < e2; j++) {
+			float e = Dist2LsLs(ls1, LineSeg2(px2[j], py2[j], px2[(j + 1) % n2], py2[(j + 1) % n2]));
+			if ((i == 0 && j == 0) || e < d)
+				d = e;
+		}
+	}
+	return d;
+}
+
+// Core of each primitive for Dist2: up to 4 vertices into px, py (returns how many) and the radius around them
+inline int Dist2GetCore(const Point2 &p, float *px, float *py, float *pR) {
+	px[0] = p.x; py[0] = p.y;
+	*pR = 0;
+	return 1;
+}
+inline int Dist2GetCore(const Aabb2 &a, float *px, float *py, float *pR) {
+	px[0] = a.minX; py[0] = a.minY;
+	px[1] = a.maxX; py[1] = a.minY;
+	px[2] = a.maxX; py[2] = a.maxY;
+	px[3] = a.minX; py[3] = a.maxY;
+	*pR = 0;
+	return 4;
+}
+inline int Dist2GetCore(const Obb2 &o, float *px, float *py, float *pR) {
+	// Local x along the orientation, local y along its perpendicular (as Cd2PO)
+	float hw = fabs(o.halfW), hh = fabs(o.halfH);
+	float wx = o.orientX * hw, wy = o.orientY * hw, hx = -o.orientY * hh, hy = o.orientX * hh;
+	px[0] = o.cx + wx + hx; py[0] = o.cy + wy + hy;
+	px[1] = o.cx - wx + hx; py[1] = o.cy - wy + hy;
+	px[2] = o.cx - wx - hx; py[2] = o.cy - wy - hy;
+	px[3] = o.cx + wx - hx; py[3] = o.cy + wy - hy;
+	*pR = 0;
+	return 4;
+}
+inline int Dist2GetCore(const LineSeg2 &ls, float *px, float *py, float *pR) {
+	px[0] = ls.x1; py[0] = ls.y1;
+	px[1] = ls.x2; py[1] = ls.y2;
+	*pR = 0;
+	return 2;
+}
+inline int Dist2GetCore(const Triangle2 &t, float *px, float *py, float *pR) {
+	px[0] = t.x1; py[0] = t.y1;
+	px[1] = t.x2; py[1] = t.y2;
+	px[2] = t.x3; py[2] = t.y3;
+	*pR = 0;
+	return 3;
+}
+inline int Dist2GetCore(const Circle2 &c, float *px, float *py, float *pR) {
+	px[0] = c.x; py[0] = c.y;
+	*pR = c.r;
+	return 1;
+}
+inline int Dist2GetCore(const Capsule2 &k, float *px, float *py, float *pR) {
+	px[0] = k.x1; py[0] = k.y1;
+	px[1] = k.x2; py[1] = k.y2;
+	*pR = k.r;
+	return 2;
+}
+
+// Distance 2d squared: any primitive and any primitive, between the cores less the squared radii
+template <class A, class B> inline float Dist2(const A &a, const B &b) {
+	float px1[4], py1[4], px2[4], py2[4], r1, r2;
+	int n1 = Dist2GetCore(a, px1, py1, &r1), n2 = Dist2GetCore(b, px2, py2, &r2);
+	return Dist2NN(px1, py1, n1, px2, py2, n2) - r1 * r1 - r2 * r2;
+}
+
+// Squared gap between any primitive and any primitive: 0 if they touch
+template <class A, class B> inline float Dist2Gap(const A &a, const B &b) {
+	float px1[4], py1[4], px2[4], py2[4], r1, r2;
+	int n1 = Dist2GetCore(a, px1, py1, &r1), n2 = Dist2GetCore(b, px2, py2, &r2);
+	float d = Dist2NN(px1, py1, n1, px2, py2, n2);
+	if (r1 == 0 && r2 == 0)
+		return d;
+	d = sqrt(d) - fabs(r1) - fabs(r2);
+	return d > 0 ? d * d : 0;
+}
+
+template <class A> struct Dist2GapShapeInner {
+	const A &a;
+	float ret;
+	template <class B> void operator()(const B &b) { ret = Dist2Gap(a, b); }
+};
+
+struct Dist2GapShapeOuter {
+	const Shape2 &b;
+	float ret;
+	template <class A> void operator()(const A &a) {
+		Dist2GapShapeInner<A> inner = { a, 0 };
+		Shape2Visit(b, inner);
+		ret = inner.ret;
+	}
+};
+
+// Squared gap between any shape and any shape
+inline float Dist2Gap(const Shape2 &a, const Shape2 &b) {
+	Dist2GapShapeOuter outer = { b, 0 };
+	Shape2Visit(a, outer);
+	return outer.ret;
+}
+
+// Distance 2d squared: Point and Obb
+inline float Dist2PO(Point2 p, Obb2 o) { return Dist2(p, o); }
+
+// Distance 2d squared: Point and Triangle
+inline float Dist2PT(Point2 p, Triangle2 t) { return Dist2(p, t); }
+
+// Distance 2d squared: Aabb and Aabb
+inline float Dist2AA(Aabb2 a1, Aabb2 a2) { return Dist2(a1, a2); }
+
+// Distance 2d squared: Aabb and Obb
+inline float Dist2AO(Aabb2 a, Obb2 o) { return Dist2(a, o); }
+
+// Distance 2d squared: Aabb and Line Segment
+inline float Dist2ALs(Aabb2 a, LineSeg2 ls) { return Dist2(a, ls); }
+
+// Distance 2d squared: Aabb and Triangle
+inline float Dist2AT(Aabb2 a, Triangle2 t) { return Dist2(a, t); }
+
+// Distance 2d squared: Aabb and Circle
+inline float Dist2AC(Aabb2 a, Circle2 c) { return Dist2(a, c); }
+
+// Distance 2d squared: Aabb and Capsule
+inline float Dist2ACap(Aabb2 a, Capsule2 k) { return Dist2(a, k); }
+
+// Distance 2d squared: Obb and Obb
+inline float Dist2OO(Obb2 o1, Obb2 o2) { return Dist2(o1, o2); }
+
+// Distance 2d squared: Obb and Line Segment
+inline float Dist2OLs(Obb2 o, LineSeg2 ls) { return Dist2(o, ls); }
+
+// Distance 2d squared: Obb and Triangle
+inline float Dist2OT(Obb2 o, Triangle2 t) { return Dist2(o, t); }
+
+// Distance 2d squared: Obb and Circle
+inline float Dist2OC(Obb2 o, Circle2 c) { return Dist2(o, c); }
+
+// Distance 2d squared: Obb and Capsule
+inline float Dist2OCap(Obb2 o, Capsule2 k) { return Dist2(o, k); }
+
+// Distance 2d squared: Line Segment and Triangle
+inline float Dist2LsT(LineSeg2 ls, Triangle2 t) { return Dist2(ls, t); }
+
+// Distance 2d squared: Line Segment and Circle
+inline float Dist2LsC(LineSeg2 ls, Circle2 c) { return Dist2(ls, c); }
+
+// Distance 2d squared: Triangle and Triangle
+inline float Dist2TT(Triangle2 t1, Triangle2 t2) { return Dist2(t1, t2); }
+
+// Distance 2d squared: Triangle and Circle
+inline float Dist2TC(Triangle2 t, Circle2 c) { return Dist2(t, c); }
+
+// Distance 2d squared: Triangle and Capsule
+inline float Dist2TCap(Triangle2 t, Capsule2 k) { return Dist2(t, k); }
+
+// Distance 2d squared: Obb and Point
+inline float Dist2OP(Obb2 o, Point2 p) { return Dist2PO(p, o); }
+
+// Distance 2d squared: Triangle and Point
+inline float Dist2TP(Triangle2 t, Point2 p) { return Dist2PT(p, t); }
+
+// Distance 2d squared: Obb and Aabb
+inline float Dist2OA(Obb2 o, Aabb2 a) { return Dist2AO(a, o); }
+
+// Distance 2d squared: Line Segment and Aabb
+inline float Dist2LsA(LineSeg2 ls, Aabb2 a) { return Dist2ALs(a, ls); }
+
+// Distance 2d squared: Triangle and Aabb
+inline float Dist2TA(Triangle2 t, Aabb2 a) { return Dist2AT(a, t); }
+
+// Distance 2d squared: Circle and Aabb
+inline float Dist2CA(Circle2 c, Aabb2 a) { return Dist2AC(a, c); }
+
+// Distance 2d squared: Capsule and Aabb
+inline float Dist2CapA(Capsule2 k, Aabb2 a) { return Dist2ACap(a, k); }
+
+// Distance 2d squared: Line Segment and Obb
+inline float Dist2LsO(LineSeg2 ls, Obb2 o) { return Dist2OLs(o, ls); }
+
+// Distance 2d squared: Triangle and Obb
+inline float Dist2TO(Triangle2 t, Obb2 o) { return Dist2OT(o, t); }
+
+// Distance 2d squared: Circle and Obb
+inline float Dist2CO(Circle2 c, Obb2 o) { return Dist2OC(o, c); }
+
+// Distance 2d squared: Capsule and Obb
+inline float Dist2CapO(Capsule2 k, Obb2 o) { return Dist2OCap(o, k); }
+
+// Distance 2d squared: Triangle and Line Segment
+inline float Dist2TLs(Triangle2 t, LineSeg2 ls) { return Dist2LsT(ls, t); }
+
+// Distance 2d squared: Circle and Line Segment
+inline float Dist2CLs(Circle2 c, LineSeg2 ls) { return Dist2LsC(ls, c); }
+
+// Distance 2d squared: Circle and Triangle
+inline float Dist2CT(Circle2 c, Triangle2 t) { return Dist2TC(t, c); }
+
+// Distance 2d squared: Capsule and Triangle
+inline float Dist2CapT(Capsule2 k, Triangle2 t) { return Dist2TCap(t, k); }
+
 }  // namespace
 
 #endif  // _SAW_GEOM_CD2_INCLUDED
@@ -0,0 +1,471 @@
+// saw_geom_grid2.h - Grids over static 2d geometry
+//                   - Bit grid occupancy for constant time point queries
+//                   - Signed distance field with parallel jump flooding build
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.03 - 10/19/26 - Fixed BitGrid2TestPoint(s) missing shapes on the max edges of the grid
+// - v1.02 - 10/19/26 - Sdf2 of Capsule2
+// - v1.01 - 10/19/26 - Added Sdf2
+// - v1.00 - 10/19/26 - Initial release: BitGrid2
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Builds on saw_geom_cd2.h, and saw_job.h for threads
+//
+// - Bit grid
+//   - Static shapes (Shape2) are rasterized into two packed bitsets over a width x height grid:
+//     "touched" for every cell a shape overlaps, and "inside" for every cell completely inside a shape
+//   - Rasterization is conservative: cells are grown by a small epsilon before the exact Cd2 cell
+//     tests, so float error in computing a point's cell can never lose a hit
+//   - BitGrid2TestPoint: untouched cell - false, inside cell - true, otherwise exact Cd2 tests against
+//     the shapes listed for that cell only. Points on the max edges count as in the last column or row;
+//     points outside the grid bounds test only the shapes that stick out of the grid.
+//   - BitGrid2TestPoints does 4 points at a time with SSE2: cell indices are computed in SIMD and
+//     the bit words gathered (SSE2 has no gather instruction, so loaded one by one); only boundary
+//     cells drop to the exact tests
+//
+// - Signed distance field
+//   - Samples on a width x height lattice spanning bounds (corners included) hold the distance to the
+//     nearest shape, negative inside: the union of the shapes' own signed distances (exact outside,
+//     a lower bound on depth inside)
+//   - Build: every shape seeds the samples within a cell of its bounds with its exact distance, then
+//     jump flooding (steps of half the grid down to 1, plus a final step of 1) passes each sample's
+//     nearest shape to its neighbours. Passes run rows in parallel on a JobPool and read one buffer
+//     while writing the other, so the result does not depend on the number of threads.
+//   - Each sample keeps the index of its nearest shape, so distances are exact to that shape and
+//     Sdf2Sample can refine near the surface: within band of zero it replaces the bilinear estimate
+//     with the exact distance to the nearest shapes of the 4 surrounding samples (Dist2PLs, Dist2PP)
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Requires saw_job.h; define SAW_JOB_IMPLEMENTATION in one file
+// - Functionality is in sawg:: namespace
+
+#ifndef _SAW_GEOM_GRID2_INCLUDED
+#define _SAW_GEOM_GRID2_INCLUDED
+
+#include <vector>
+#include "saw_geom_cd2.h"
+#include "saw_job.h"
+
+namespace sawg {
+
+//-----------------------------------------------------------------------------------------------------------
+// BIT GRID
+//-----------------------------------------------------------------------------------------------------------
+
+static const float BITGRID2_EPSILON = 1E-3f;  // Cell growth for rasterization, in cells
+
+struct BitGrid2 {
+	Aabb2 bounds;
+	int width, height;
+	float invCellW, invCellH;
+	std::vector<unsigned int> touched;    // One bit per cell, row major
+	std::vector<unsigned int> inside;
+	std::vector<unsigned int> cellStart;  // Shapes of cell c are cellShapes[cellStart[c]] to cellShapes[cellStart[c + 1] - 1]
+	std::vector<unsigned int> cellShapes; // Listed only for touched cells that are not inside
+	std::vector<unsigned int> outside;    // Shapes reaching past bounds
+	std::vector<Shape2> shapes;
+	BitGrid2() : width(0), height(0), invCellW(0), invCellH(0) { }
+};
+
+struct BitGrid2Bounds {
+	Aabb2 box;
+	template <class T> void operator()(const T &prim) { box = CalcAabb2(prim); }
+};
+
+// Does cell overlap / lie completely inside a primitive
+struct BitGrid2CellTest {
+	Aabb2 cell;
+	bool touched, inside;
+	template <class T> void operator()(const T &prim) {
+		touched = Cd2(cell, prim);
+		inside = touched && Cd2(Point2(cell.minX, cell.minY), prim) && Cd2(Point2(cell.maxX, cell.minY), prim) &&
+			Cd2(Point2(cell.minX, cell.maxY), prim) && Cd2(Point2(cell.maxX, cell.maxY), prim);
+	}
+	void operator()(const LineSeg2 &ls) {
+		touched = Cd2(cell, ls);
+		inside = false;
+	}
+	void operator()(const Point2 &p) {
+		touched = Cd2(cell, p);
+		inside = false;
+	}
+};
+
+inline bool BitGrid2Get(const std::vector<unsigned int> &bits, size_t cell) {
+	return (bits[cell >> 5] >> (cell & 31)) & 1;
+}
+
+// Range of cells a box covers, clamped to the grid; false if it misses the grid
+inline bool BitGrid2CellRange(const BitGrid2 &g, const Aabb2 &box, int *pX0, int *pY0, int *pX1, int *pY1) {
+	float x0 = (box.minX - g.bounds.minX) * g.invCellW - BITGRID2_EPSILON;
+	float y0 = (box.minY - g.bounds.minY) * g.invCellH - BITGRID2_EPSILON;
+	float x1 = (box.maxX - g.bounds.minX) * g.invCellW + BITGRID2_EPSILON;
+	float y1 = (box.maxY - g.bounds.minY) * g.invCellH + BITGRID2_EPSILON;
+	if (x1 < 0 || y1 < 0 || x0 >= g.width || y0 >= g.height)
+		return false;
+	*pX0 = x0 < 0 ? 0 : static_cast<int>(x0);
+	*pY0 = y0 < 0 ? 0 : static_cast<int>(y0);
+	*pX1 = x1 >= g.width ? g.width - 1 : static_cast<int>(x1);
+	*pY1 = y1 >= g.height ? g.height - 1 : static_cast<int>(y1);
+	return true;
+}
+
+// Rasterize shapes into a width x height grid over bounds
+inline void BitGrid2Build(BitGrid2 *g, const Aabb2 &bounds, int width, int height, const Shape2 *shapes, size_t n) {
+	g->bounds = bounds;
+	g->width = width;
+	g->height = height;
+	g->invCellW = width / (bounds.maxX - bounds.minX);
+	g->invCellH = height / (bounds.maxY - bounds.minY);
+	size_t numCells = static_cast<size_t>(width) * height;
+	g->touched.assign((numCells + 31) / 32, 0);
+	g->inside.assign((numCells + 31) / 32, 0);
+	g->cellStart.assign(numCells + 1, 0);
+	g->cellShapes.clear();
+	g->outside.clear();
+	g->shapes.assign(shapes, shapes + n);
+	float cellW = (bounds.maxX - bounds.minX) / width, cellH = (bounds.maxY - bounds.minY) / height;
+	float growX = cellW * BITGRID2_EPSILON, growY = cellH * BITGRID2_EPSILON;
+
+	// Two passes: mark bits and count boundary shapes per cell, then fill the lists
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < n; i++) {
+			BitGrid2Bounds b;
+			b.box = Aabb2(1, 1, -1, -1);
+			Shape2Visit(shapes[i], b);
+			if (pass == 0 && (b.box.minX < bounds.minX || b.box.minY < bounds.minY || b.box.maxX > bounds.maxX || b.box.maxY > bounds.maxY))
+				g->outside.push_back(static_cast<unsigned int>(i));
+			int x0, y0, x1, y1;
+			if (b.box.minX > b.box.maxX || !BitGrid2CellRange(*g, b.box, &x0, &y0, &x1, &y1))
+				continue;
+			for (int y = y0; y <= y1; y++) {
+				for (int x = x0; x <= x1; x++) {
+					size_t c = static_cast<size_t>(y) * width + x;
+					BitGrid2CellTest t;
+					t.touched = t.inside = false;
+					t.cell = Aabb2(bounds.minX + x * cellW - growX, bounds.minY + y * cellH - growY,
+						bounds.minX + (x + 1) * cellW + growX, bounds.minY + (y + 1) * cellH + growY);
+					Shape2Visit(shapes[i], t);
+					if (!t.touched)
+						continue;
+					if (pass == 0) {
+						g->touched[c >> 5] |= 1u << (c & 31);
+						if (t.inside)
+							g->inside[c >> 5] |= 1u << (c & 31);
+						g->cellStart[c + 1]++;
+					} else if (!BitGrid2Get(g->inside, c)) {
+						g->cellShapes[g->cellStart[c]++] = static_cast<unsigned int>(i);
+					}
+				}
+			}
+		}
+		if (pass == 0) {
+			// Inside cells never need their lists
+			for (size_t c = 0; c < numCells; c++)
+				if (BitGrid2Get(g->inside, c))
+					g->cellStart[c + 1] = 0;
+			for (size_t c = 0; c < numCells; c++)
+				g->cellStart[c + 1] += g->cellStart[c];
+			g->cellShapes.resize(g->cellStart[numCells]);
+		}
+	}
+	// The fill advanced each start to the next cell's start
+	for (size_t c = numCells; c > 0; c--)
+		g->cellStart[c] = g->cellStart[c - 1];
+	g->cellStart[0] = 0;
+}
+
+inline bool BitGrid2TestShapes(const BitGrid2 &g, const unsigned int *list, size_t count, float x, float y) {
+	Shape2 p = Shape2Make(Point2(x, y));
+	for (size_t i = 0; i < count; i++)
+		if (Cd2(p, g.shapes[list[i]]))
+			return true;
+	return false;
+}
+
+// Exact answer for a cell with both bits known
+inline bool BitGrid2Resolve(const BitGrid2 &g, size_t cell, float x, float y) {
+	unsigned int start = g.cellStart[cell], end = g.cellStart[cell + 1];
+	return start != end && BitGrid2TestShapes(g, &g.cellShapes[start], end - start, x, y);
+}
+
+inline bool BitGrid2TestOutside(const BitGrid2 &g, float x, float y) {
+	return !g.outside.empty() && BitGrid2TestShapes(g, &g.outside[0], g.outside.size(), x, y);
+}
+
+// Is the point inside (or on) any shape
+inline bool BitGrid2TestPoint(const BitGrid2 &g, float x, float y) {
+	// Points on the max edges belong to the last column or row, as outside only holds shapes reaching past bounds
+	if (!(x >= g.bounds.minX && y >= g.bounds.minY && x <= g.bounds.maxX && y <= g.bounds.maxY))
+		return BitGrid2TestOutside(g, x, y);
+	int cx = static_cast<int>((x - g.bounds.minX) * g.invCellW), cy = static_cast<int>((y - g.bounds.minY) * g.invCellH);
+	cx = cx < g.width ? cx : g.width - 1;
+	cy = cy < g.height ? cy : g.height - 1;
+	size_t c = static_cast<size_t>(cy) * g.width + cx;
+	if (!BitGrid2Get(g.touched, c))
+		return false;
+	if (BitGrid2Get(g.inside, c))
+		return true;
+	return BitGrid2Resolve(g, c, x, y);
+}
+
+// Test n points; pOut[i] is the result for point i
+inline void BitGrid2TestPoints(const BitGrid2 &g, const float *px, const float *py, size_t n, bool *pOut) {
+	size_t i = 0;
+#ifdef SAW_GEOM_SSE2
+	__m128 minX = _mm_set1_ps(g.bounds.minX), minY = _mm_set1_ps(g.bounds.minY);
+	__m128 maxX = _mm_set1_ps(g.bounds.maxX), maxY = _mm_set1_ps(g.bounds.maxY);
+	__m128 invW = _mm_set1_ps(g.invCellW), invH = _mm_set1_ps(g.invCellH);
+	__m128 w = _mm_set1_ps(static_cast<float>(g.width));
+	__m128 lastX = _mm_set1_ps(static_cast<float>(g.width - 1)), lastY = _mm_set1_ps(static_cast<float>(g.height - 1));
+	for (; i + 4 <= n; i += 4) {
+		__m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i);
+		__m128 in = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x, minX), _mm_cmpge_ps(y, minY)),
+			_mm_and_ps(_mm_cmple_ps(x, maxX), _mm_cmple_ps(y, maxY)));
+		// Max edges clamp into the last column and row, as in BitGrid2TestPoint
+		__m128 fx = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(x, minX), invW), lastX);
+		__m128 fy = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(y, minY), invH), lastY);
+		// Row * width + column in floats (exact below 2^24 cells), zeroed for lanes outside
+		__m128 cx = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_and_ps(fx, in)));
+		__m128 cy = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_and_ps(fy, in)));
+		int cells[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(cells), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(cy, w), cx)));
+		int inMask = _mm_movemask_ps(in);
+		for (int k = 0; k < 4; k++) {
+			size_t c = static_cast<size_t>(cells[k]);
+			if (!(inMask & (1 << k)))
+				pOut[i + k] = BitGrid2TestOutside(g, px[i + k], py[i + k]);
+			else if (!BitGrid2Get(g.touched, c))
+				pOut[i + k] = false;
+			else
+				pOut[i + k] = BitGrid2Get(g.inside, c) || BitGrid2Resolve(g, c, px[i + k], py[i + k]);
+		}
+	}
+#endif
+	for (; i < n; i++)
+		pOut[i] = BitGrid2TestPoint(g, px[i], py[i]);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// SIGNED DISTANCE FIELD
+//-----------------------------------------------------------------------------------------------------------
+
+static const unsigned int SDF2_NONE = 0xffffffff;
+
+struct Sdf2 {
+	Aabb2 bounds;
+	int width, height;                 // Samples per row and column, at least 2 each
+	float stepX, stepY;                // Distance between samples
+	std::vector<float> dist;           // Row major
+	std::vector<unsigned int> nearest; // Shape each sample's distance is to
+	std::vector<Shape2> shapes;
+	Sdf2() : width(0), height(0), stepX(0), stepY(0) { }
+};
+
+// Signed distance from a point to one primitive, negative inside
+struct Sdf2ShapeDist {
+	float x, y, d;
+	static float Box(float dx, float dy) {
+		if (dx <= 0 && dy <= 0)
+			return dx > dy ? dx : dy;
+		dx = dx > 0 ? dx : 0;
+		dy = dy > 0 ? dy : 0;
+		return sqrt(dx * dx + dy * dy);
+	}
+	void operator()(const Point2 &p) { d = sqrt(Dist2PP(Point2(x, y), p)); }
+	void operator()(const LineSeg2 &ls) { d = sqrt(Dist2PLs(Point2(x, y), ls)); }
+	void operator()(const Circle2 &c) { d = sqrt(Dist2PP(Point2(x, y), Point2(c.x, c.y))) - fabs(c.r); }
+	void operator()(const Capsule2 &k) { d = sqrt(Dist2PLs(Point2(x, y), Capsule2GetSeg(k))) - fabs(k.r); }
+	void operator()(const Aabb2 &a) { d = Box(a.minX - x > x - a.maxX ? a.minX - x : x - a.maxX, a.minY - y > y - a.maxY ? a.minY - y : y - a.maxY); }
+	void operator()(const Obb2 &o) {
+		float rx = x - o.cx, ry = y - o.cy;
+		d = Box(fabs(rx * o.orientX + ry * o.orientY) - fabs(o.halfW), fabs(ry * o.orientX - rx * o.orientY) - fabs(o.halfH));
+	}
+	void operator()(const Triangle2 &t) {
+		Point2 p(x, y);
+		float d1 = Dist2PLs(p, LineSeg2(t.x1, t.y1, t.x2, t.y2));
+		float d2 = Dist2PLs(p, LineSeg2(t.x2, t.y2, t.x3, t.y3));
+		float d3 = Dist2PLs(p, LineSeg2(t.x3, t.y3, t.x1, t.y1));
+		float m = d1 < d2 ? d1 : d2;
+		d = sqrt(m < d3 ? m : d3);
+		if (Cd2PT(p, t))
+			d = -d;
+	}
+};
+
+inline float Sdf2GetShapeDist(const Shape2 &s, float x, float y) {
+	Sdf2ShapeDist f = { x, y, 1E+37f };
+	Shape2Visit(s, f);
+	return f.d;
+}
+
+struct Sdf2FloodJob {
+	const Sdf2 *pSdf;
+	const unsigned int *srcNearest;
+	const float *srcDist;
+	unsigned int *dstNearest;
+	float *dstDist;
+	int step;
+};
+
+inline void Sdf2FloodTask(size_t row, int, void *user) {
+	const Sdf2FloodJob &job = *static_cast<Sdf2FloodJob *>(user);
+	const Sdf2 &sdf = *job.pSdf;
+	int y = static_cast<int>(row), w = sdf.width;
+	float py = sdf.bounds.minY + y * sdf.stepY;
+	for (int x = 0; x < w; x++) {
+		size_t at = static_cast<size_t>(y) * w + x;
+		unsigned int best = job.srcNearest[at];
+		float bestD = job.srcDist[at];
+		float px = sdf.bounds.minX + x * sdf.stepX;
+		for (int dy = -1; dy <= 1; dy++) {
+			int ny = y + dy * job.step;
+			if (ny < 0 || ny >= sdf.height)
+				continue;
+			for (int dx = -1; dx <= 1; dx++) {
+				int nx = x + dx * job.step;
+				if (nx < 0 || nx >= w)
+					continue;
+				unsigned int cand = job.srcNearest[static_cast<size_t>(ny) * w + nx];
+				if (cand == SDF2_NONE || cand == best)
+					continue;
+				float d = Sdf2GetShapeDist(sdf.shapes[cand], px, py);
+				if (best == SDF2_NONE || d < bestD || (d == bestD && cand < best)) {
+					best = cand;
+					bestD = d;
+				}
+			}
+		}
+		job.dstNearest[at] = best;
+		job.dstDist[at] = bestD;
+	}
+}
+
+// Bake the distance to shapes into width x height samples over bounds. pool may be null.
+inline void Sdf2Build(saw::JobPool *pool, Sdf2 *pSdf, const Aabb2 &bounds, int width, int height,
+	const Shape2 *shapes, size_t n) {
+	Sdf2 &sdf = *pSdf;
+	width = width < 2 ? 2 : width;
+	height = height < 2 ? 2 : height;
+	sdf.bounds = bounds;
+	sdf.width = width;
+	sdf.height = height;
+	sdf.stepX = (bounds.maxX - bounds.minX) / (width - 1);
+	sdf.stepY = (bounds.maxY - bounds.minY) / (height - 1);
+	sdf.shapes.assign(shapes, shapes + n);
+	size_t numSamples = static_cast<size_t>(width) * height;
+	sdf.dist.assign(numSamples, 1E+37f);
+	sdf.nearest.assign(numSamples, SDF2_NONE);
+
+	// Seed the samples around each shape with its exact distance
+	for (size_t i = 0; i < n; i++) {
+		BitGrid2Bounds b;
+		b.box = Aabb2(1, 1, -1, -1);
+		Shape2Visit(shapes[i], b);
+		if (b.box.minX > b.box.maxX)
+			continue;
+		float fx0 = (b.box.minX - bounds.minX) / sdf.stepX - 1, fx1 = (b.box.maxX - bounds.minX) / sdf.stepX + 1;
+		float fy0 = (b.box.minY - bounds.minY) / sdf.stepY - 1, fy1 = (b.box.maxY - bounds.minY) / sdf.stepY + 1;
+		int x0 = fx0 < 0 ? 0 : (fx0 > width - 1 ? width - 1 : static_cast<int>(fx0));
+		int y0 = fy0 < 0 ? 0 : (fy0 > height - 1 ? height - 1 : static_cast<int>(fy0));
+		int x1 = fx1 < 0 ? 0 : (fx1 > width - 1 ? width - 1 : static_cast<int>(fx1) + 1);
+		int y1 = fy1 < 0 ? 0 : (fy1 > height - 1 ? height - 1 : static_cast<int>(fy1) + 1);
+		if (x1 > width - 1) x1 = width - 1;
+		if (y1 > height - 1) y1 = height - 1;
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				size_t at = static_cast<size_t>(y) * width + x;
+				float d = Sdf2GetShapeDist(shapes[i], bounds.minX + x * sdf.stepX, bounds.minY + y * sdf.stepY);
+				if (d < sdf.dist[at]) {
+					sdf.dist[at] = d;
+					sdf.nearest[at] = static_cast<unsigned int>(i);
+				}
+			}
+		}
+	}
+
+	// Jump flooding, ping-ponging between the sdf and temporary buffers
+	std::vector<unsigned int> tempNearest(numSamples);
+	std::vector<float> tempDist(numSamples);
+	int step = 1;
+	while (step * 2 < (width > height ? width : height))
+		step *= 2;
+	bool inTemp = false;
+	for (; ; step /= 2) {
+		for (int extra = 0; extra < (step == 1 ? 2 : 1); extra++) {
+			Sdf2FloodJob job = { pSdf, inTemp ? &tempNearest[0] : &sdf.nearest[0], inTemp ? &tempDist[0] : &sdf.dist[0],
+				inTemp ? &sdf.nearest[0] : &tempNearest[0], inTemp ? &sdf.dist[0] : &tempDist[0], step };
+			saw::JobPoolFor(pool, height, Sdf2FloodTask, &job);
+			inTemp = !inTemp;
+		}
+		if (step == 1)
+			break;
+	}
+	if (inTemp) {
+		sdf.nearest.swap(tempNearest);
+		sdf.dist.swap(tempDist);
+	}
+}
+
+// Distance at a point, bilinear between samples (clamped to bounds).
+// Within band of the surface, the exact distance to the nearest shapes of the surrounding samples instead.
+inline float Sdf2Sample(const Sdf2 &sdf, float x, float y, float band = 0) {
+	float fx = (x - sdf.bounds.minX) / sdf.stepX, fy = (y - sdf.bounds.minY) / sdf.stepY;
+	fx = fx < 0 ? 0 : (fx > sdf.width - 1 ? static_cast<float>(sdf.width - 1) : fx);
+	fy = fy < 0 ? 0 : (fy > sdf.height - 1 ? static_cast<float>(sdf.height - 1) : fy);
+	int ix = static_cast<int>(fx), iy = static_cast<int>(fy);
+	ix = ix > sdf.width - 2 ? sdf.width - 2 : ix;
+	iy = iy > sdf.height - 2 ? sdf.height - 2 : iy;
+	float tx = fx - ix, ty = fy - iy;
+	size_t at = static_cast<size_t>(iy) * sdf.width + ix;
+	const float *d = &sdf.dist[at];
+	float top = d[0] + (d[1] - d[0]) * tx;
+	float bottom = d[sdf.width] + (d[sdf.width + 1] - d[sdf.width]) * tx;
+	float ret = top + (bottom - top) * ty;
+	if (!(fabs(ret) < band))
+		return ret;
+
+	unsigned int cand[4] = { sdf.nearest[at], sdf.nearest[at + 1], sdf.nearest[at + sdf.width], sdf.nearest[at + sdf.width + 1] };
+	float exact = 1E+37f;
+	for (int i = 0; i < 4; i++) {
+		if (cand[i] == SDF2_NONE || (i > 0 && cand[i] == cand[i - 1]))
+			continue;
+		float e = Sdf2GetShapeDist(sdf.shapes[cand[i]], x, y);
+		exact = e < exact ? e : exact;
+	}
+	return exact < 1E+37f ? exact : ret;
+}
+
+// Sdf2Sample of n points
+inline void Sdf2SampleBatch(const Sdf2 &sdf, const float *px, const float *py, size_t n, float band, float *pOut) {
+	for (size_t i = 0; i < n; i++)
+		pOut[i] = Sdf2Sample(sdf, px[i], py[i], band);
+}
+
+}  // namespace
+
+#endif  // _SAW_GEOM_GRID2_INCLUDED
@@ -0,0 +1,496 @@
+// saw_geom_poly2.h - Polygons for 2d collision detection
+//                   - Allocation free convex hulls, single or batched in parallel
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.01 - 10/19/26 - Added Poly2 (prepared non-convex polygon) and Poly2Decompose
+// - v1.00 - 10/19/26 - Initial release: ConvexHull2 and ConvexHull2Batch
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Builds on saw_geom_cd2.h, and saw_job.h for threads
+//
+// - Convex hull
+//   - Andrew's monotone chain over points sorted by x, then y
+//   - Sorting is an LSD radix sort on the float bits (8 passes of 8 bits, all histograms made in one
+//     read of the keys, passes where every key shares the digit skipped); small inputs use insertion
+//   - Nothing is allocated: the caller passes a work buffer of ConvexHull2GetWorkSize(n) entries and
+//     output arrays of n entries
+//   - Output is counter-clockwise (y up) with no repeated or collinear points, as separate x and y
+//     arrays that go straight into Cd2NN
+//   - ConvexHull2Batch builds many hulls, packed back to back, as tasks on a JobPool
+//
+// - Non-convex polygon
+//   - Poly2 is a polygon of one or more rings (holes are rings too; the even-odd rule decides inside)
+//     prepared for point queries: its edges are bucketed into horizontal slabs, copied so each slab's
+//     edges are contiguous, and a point only runs the crossing test on the edges of its own slab
+//   - An edge goes in every slab its y range touches, using the same slab function as the query, so
+//     results equal the crossing test over all edges exactly
+//   - Slab count defaults to about POLY2_SLAB_EDGES edges per slab
+//   - Poly2TestPoints tests many points as tasks on a JobPool
+//
+// - Convex decomposition
+//   - Poly2Decompose splits a simple polygon (one ring, no holes) into convex pieces for Cd2NN:
+//     ear clipping into triangles, then Hertel-Mehlhorn merging across each diagonal that leaves
+//     both its ends convex (at most 4 times the minimum number of pieces)
+//   - Ear clipping is O(n^2); decompose once, when the polygon is loaded
+//   - Pieces are counter-clockwise and packed back to back, as ConvexHull2Batch
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Requires saw_job.h; define SAW_JOB_IMPLEMENTATION in one file
+// - Functionality is in sawg:: namespace
+
+#ifndef _SAW_GEOM_POLY2_INCLUDED
+#define _SAW_GEOM_POLY2_INCLUDED
+
+#include <string.h>
+#include <map>
+#include <vector>
+#include "saw_geom_cd2.h"
+#include "saw_job.h"
+
+namespace sawg {
+
+//-----------------------------------------------------------------------------------------------------------
+// CONVEX HULL
+//-----------------------------------------------------------------------------------------------------------
+
+static const int CONVEXHULL2_INSERTION_SORT = 32;  // Inputs up to this size skip the radix sort
+
+// Entries of the work buffer for a hull of n points
+inline size_t ConvexHull2GetWorkSize(int n) {
+	return n > 0 ? static_cast<size_t>(n) * 4 : 0;
+}
+
+// Float bits mapped so unsigned order is float order (-0 is folded into +0)
+inline unsigned int ConvexHull2Key(float f) {
+	f += 0.0f;
+	unsigned int u;
+	memcpy(&u, &f, sizeof(u));
+	return u & 0x80000000 ? ~u : u | 0x80000000;
+}
+
+// Indices of the points sorted by x, then y, into pIdx; work has 3 * n entries
+inline void ConvexHull2Sort(const float *px, const float *py, int n, unsigned int *pIdx, unsigned int *work) {
+	unsigned int *keyX = work, *keyY = work + n, *temp = work + 2 * n;
+	for (int i = 0; i < n; i++) {
+		keyX[i] = ConvexHull2Key(px[i]);
+		keyY[i] = ConvexHull2Key(py[i]);
+		pIdx[i] = static_cast<unsigned int>(i);
+	}
+	if (n <= CONVEXHULL2_INSERTION_SORT) {
+		for (int i = 1; i < n; i++) {
+			unsigned int idx = pIdx[i];
+			int j = i;
+			for (; j > 0; j--) {
+				unsigned int prev = pIdx[j - 1];
+				if (keyX[prev] < keyX[idx] || (keyX[prev] == keyX[idx] && keyY[prev] <= keyY[idx]))
+					break;
+				pIdx[j] = prev;
+			}
+			pIdx[j] = idx;
+		}
+		return;
+	}
+
+	// Digits 0-3 are y, least significant first, then 4-7 are x
+	unsigned int hist[8][256];
+	memset(hist, 0, sizeof(hist));
+	for (int i = 0; i < n; i++) {
+		for (int d = 0; d < 4; d++) {
+			hist[d][(keyY[i] >> (d * 8)) & 0xff]++;
+			hist[4 + d][(keyX[i] >> (d * 8)) & 0xff]++;
+		}
+	}
+	unsigned int *src = pIdx, *dst = temp;
+	for (int d = 0; d < 8; d++) {
+		const unsigned int *keys = d < 4 ? keyY : keyX;
+		int shift = (d & 3) * 8;
+		unsigned int at = 0;
+		bool skip = false;
+		for (int b = 0; b < 256; b++) {
+			unsigned int count = hist[d][b];
+			skip |= count == static_cast<unsigned int>(n);
+			hist[d][b] = at;
+			at += count;
+		}
+		if (skip)
+			continue;
+		for (int i = 0; i < n; i++)
+			dst[hist[d][(keys[src[i]] >> shift) & 0xff]++] = src[i];
+		unsigned int *t = src;
+		src = dst;
+		dst = t;
+	}
+	if (src != pIdx)
+		memcpy(pIdx, src, n * sizeof(unsigned int));
+}
+
+// Twice the signed area of o, a, b; positive if counter-clockwise
+inline float ConvexHull2Cross(const float *px, const float *py, unsigned int o, unsigned int a, unsigned int b) {
+	return (px[a] - px[o]) * (py[b] - py[o]) - (py[a] - py[o]) * (px[b] - px[o]);
+}
+
+// Convex hull of n points. Writes up to n points to pOutX/pOutY and returns the count.
+// work has ConvexHull2GetWorkSize(n) entries. Nothing is allocated.
+inline int ConvexHull2(const float *px, const float *py, int n, float *pOutX, float *pOutY, unsigned int *work) {
+	if (n <= 0)
+		return 0;
+	unsigned int *idx = work + 3 * n;
+	ConvexHull2Sort(px, py, n, idx, work);
+
+	// Lower then upper chain; the keys are no longer needed so the first 2n entries hold the chain
+	unsigned int *hull = work;
+	int k = 0;
+	for (int i = 0; i < n; i++) {
+		while (k >= 2 && ConvexHull2Cross(px, py, hull[k - 2], hull[k - 1], idx[i]) <= 0)
+			k--;
+		hull[k++] = idx[i];
+	}
+	for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+		while (k >= lower && ConvexHull2Cross(px, py, hull[k - 2], hull[k - 1], idx[i]) <= 0)
+			k--;
+		hull[k++] = idx[i];
+	}
+	int count = k > 1 ? k - 1 : k;  // The last point repeats the first
+	if (count == 2 && px[hull[0]] == px[hull[1]] && py[hull[0]] == py[hull[1]])
+		count = 1;  // Every point the same
+	for (int i = 0; i < count; i++) {
+		pOutX[i] = px[hull[i]];
+		pOutY[i] = py[hull[i]];
+	}
+	return count;
+}
+
+struct ConvexHull2BatchJob {
+	const float *px, *py;
+	const int *offsets;
+	int numHulls;
+	float *pOutX, *pOutY;
+	int *pOutCounts;
+	unsigned int *work;
+};
+
+static const int CONVEXHULL2_BATCH_GRAIN = 64;  // Hulls per task
+
+inline void ConvexHull2BatchTask(size_t task, int, void *user) {
+	const ConvexHull2BatchJob &job = *static_cast<ConvexHull2BatchJob *>(user);
+	int end = static_cast<int>(task + 1) * CONVEXHULL2_BATCH_GRAIN;
+	if (end > job.numHulls)
+		end = job.numHulls;
+	for (int h = static_cast<int>(task) * CONVEXHULL2_BATCH_GRAIN; h < end; h++) {
+		int first = job.offsets[h], n = job.offsets[h + 1] - first;
+		job.pOutCounts[h] = ConvexHull2(job.px + first, job.py + first, n, job.pOutX + first, job.pOutY + first,
+			job.work + ConvexHull2GetWorkSize(first));
+	}
+}
+
+// Hulls of many point sets packed back to back: set h is points offsets[h] to offsets[h + 1] - 1.
+// Hull h is written at the same offsets of pOutX/pOutY, with its count in pOutCounts[h].
+// work has ConvexHull2GetWorkSize(offsets[numHulls]) entries. pool may be null.
+inline void ConvexHull2Batch(saw::JobPool *pool, const float *px, const float *py, const int *offsets, int numHulls,
+	float *pOutX, float *pOutY, int *pOutCounts, unsigned int *work) {
+	ConvexHull2BatchJob job = { px, py, offsets, numHulls, pOutX, pOutY, pOutCounts, work };
+	saw::JobPoolFor(pool, (numHulls + CONVEXHULL2_BATCH_GRAIN - 1) / CONVEXHULL2_BATCH_GRAIN, ConvexHull2BatchTask, &job);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// NON-CONVEX POLYGON
+//-----------------------------------------------------------------------------------------------------------
+
+static const int POLY2_SLAB_EDGES = 8;     // Default slab count aims for this many edges per slab
+static const int POLY2_TEST_GRAIN = 1024;  // Points per task in Poly2TestPoints
+
+struct Poly2 {
+	Aabb2 bounds;
+	int numSlabs;
+	float slabScale;                       // Slabs per unit of y
+	std::vector<unsigned int> slabStart;   // Slab s is edges slabStart[s] to slabStart[s + 1] - 1
+	std::vector<LineSeg2> slabEdges;
+	Poly2() : numSlabs(0), slabScale(0) { }
+};
+
+inline int Poly2GetSlab(const Poly2 &poly, float y) {
+	float f = (y - poly.bounds.minY) * poly.slabScale;
+	int s = f > 0 ? static_cast<int>(f) : 0;
+	return s < poly.numSlabs ? s : poly.numSlabs - 1;
+}
+
+// Prepare a polygon of numRings rings: ring r is vertices ringOffsets[r] to ringOffsets[r + 1] - 1.
+// numSlabs of 0 picks one from the edge count.
+inline void Poly2BuildRings(Poly2 *pPoly, const float *px, const float *py, const int *ringOffsets, int numRings,
+	int numSlabs = 0) {
+	Poly2 &poly = *pPoly;
+	int n = numRings > 0 ? ringOffsets[numRings] - ringOffsets[0] : 0;
+	poly.bounds = Aabb2(0, 0, 0, 0);
+	if (n > 0)
+		poly.bounds = Aabb2(px[ringOffsets[0]], py[ringOffsets[0]], px[ringOffsets[0]], py[ringOffsets[0]]);
+	for (int i = ringOffsets[0]; i < ringOffsets[0] + n; i++) {
+		poly.bounds.minX = px[i] < poly.bounds.minX ? px[i] : poly.bounds.minX;
+		poly.bounds.minY = py[i] < poly.bounds.minY ? py[i] : poly.bounds.minY;
+		poly.bounds.maxX = px[i] > poly.bounds.maxX ? px[i] : poly.bounds.maxX;
+		poly.bounds.maxY = py[i] > poly.bounds.maxY ? py[i] : poly.bounds.maxY;
+	}
+	poly.numSlabs = numSlabs > 0 ? numSlabs : n / POLY2_SLAB_EDGES + 1;
+	float height = poly.bounds.maxY - poly.bounds.minY;
+	poly.slabScale = height > 0 ? poly.numSlabs / height : 0;
+
+	// Count then fill each slab's edges
+	poly.slabStart.assign(poly.numSlabs + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		for (int r = 0; r < numRings; r++) {
+			int first = ringOffsets[r], last = ringOffsets[r + 1] - 1;
+			for (int i = first, prev = last; i <= last; prev = i++) {
+				int s0 = Poly2GetSlab(poly, py[prev] < py[i] ? py[prev] : py[i]);
+				int s1 = Poly2GetSlab(poly, py[prev] < py[i] ? py[i] : py[prev]);
+				for (int s = s0; s <= s1; s++) {
+					if (pass == 0)
+						poly.slabStart[s + 1]++;
+					else
+						poly.slabEdges[poly.slabStart[s]++] = LineSeg2(px[prev], py[prev], px[i], py[i]);
+				}
+			}
+		}
+		if (pass == 0) {
+			for (int s = 0; s < poly.numSlabs; s++)
+				poly.slabStart[s + 1] += poly.slabStart[s];
+			poly.slabEdges.resize(poly.slabStart[poly.numSlabs]);
+		}
+		else {
+			// Filling advanced each start to the next slab's start
+			for (int s = poly.numSlabs; s > 0; s--)
+				poly.slabStart[s] = poly.slabStart[s - 1];
+			poly.slabStart[0] = 0;
+		}
+	}
+}
+
+// Prepare a polygon of one ring of n vertices
+inline void Poly2Build(Poly2 *pPoly, const float *px, const float *py, int n, int numSlabs = 0) {
+	int ringOffsets[2] = { 0, n };
+	Poly2BuildRings(pPoly, px, py, ringOffsets, 1, numSlabs);
+}
+
+// Point in polygon (even-odd crossing test against the edges of the point's slab)
+inline bool Poly2TestPoint(const Poly2 &poly, float x, float y) {
+	if (!(x >= poly.bounds.minX && x <= poly.bounds.maxX && y >= poly.bounds.minY && y <= poly.bounds.maxY))
+		return false;
+	int s = Poly2GetSlab(poly, y);
+	bool inside = false;
+	const LineSeg2 *e = poly.slabEdges.empty() ? 0 : &poly.slabEdges[0];
+	for (unsigned int i = poly.slabStart[s]; i < poly.slabStart[s + 1]; i++)
+		if ((e[i].y1 > y) != (e[i].y2 > y) && x < (e[i].x2 - e[i].x1) * (y - e[i].y1) / (e[i].y2 - e[i].y1) + e[i].x1)
+			inside = !inside;
+	return inside;
+}
+
+struct Poly2TestJob {
+	const Poly2 *pPoly;
+	const float *px, *py;
+	size_t n;
+	bool *pOut;
+};
+
+inline void Poly2TestTask(size_t task, int, void *user) {
+	const Poly2TestJob &job = *static_cast<Poly2TestJob *>(user);
+	size_t end = (task + 1) * POLY2_TEST_GRAIN;
+	end = end < job.n ? end : job.n;
+	for (size_t i = task * POLY2_TEST_GRAIN; i < end; i++)
+		job.pOut[i] = Poly2TestPoint(*job.pPoly, job.px[i], job.py[i]);
+}
+
+// Poly2TestPoint of n points. pool may be null.
+inline void Poly2TestPoints(saw::JobPool *pool, const Poly2 &poly, const float *px, const float *py, size_t n, bool *pOut) {
+	Poly2TestJob job = { &poly, px, py, n, pOut };
+	saw::JobPoolFor(pool, (n + POLY2_TEST_GRAIN - 1) / POLY2_TEST_GRAIN, Poly2TestTask, &job);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// CONVEX DECOMPOSITION
+//-----------------------------------------------------------------------------------------------------------
+
+// Convex pieces: piece p is vertices offsets[p] to offsets[p + 1] - 1, counter-clockwise
+struct Poly2Convex {
+	std::vector<float> x, y;
+	std::vector<int> offsets;
+};
+
+inline int Poly2GetNumPieces(const Poly2Convex &c) {
+	return c.offsets.empty() ? 0 : static_cast<int>(c.offsets.size()) - 1;
+}
+
+// True if p is inside or on triangle a, b, c (counter-clockwise)
+inline bool Poly2InTriangle(const float *px, const float *py, unsigned int a, unsigned int b, unsigned int c, unsigned int p) {
+	return ConvexHull2Cross(px, py, a, b, p) >= 0 && ConvexHull2Cross(px, py, b, c, p) >= 0 &&
+		ConvexHull2Cross(px, py, c, a, p) >= 0;
+}
+
+// Find vertex v in a piece's ring
+inline size_t Poly2FindInPiece(const std::vector<unsigned int> &piece, unsigned int v) {
+	for (size_t i = 0; i < piece.size(); i++)
+		if (piece[i] == v)
+			return i;
+	return piece.size();
+}
+
+// Convex pieces of a simple polygon of n vertices (either winding) into pOut
+inline void Poly2Decompose(const float *px, const float *py, int n, Poly2Convex *pOut) {
+	pOut->x.clear();
+	pOut->y.clear();
+	pOut->offsets.assign(1, 0);
+	if (n < 3)
+		return;
+
+	// Ring as a linked list in counter-clockwise order
+	float area = 0;
+	for (int i = 0, j = n - 1; i < n; j = i++)
+		area += px[j] * py[i] - px[i] * py[j];
+	std::vector<unsigned int> prev(n), next(n);
+	for (int i = 0; i < n; i++) {
+		unsigned int a = static_cast<unsigned int>(i == 0 ? n - 1 : i - 1), b = static_cast<unsigned int>(i == n - 1 ? 0 : i + 1);
+		prev[i] = area >= 0 ? a : b;
+		next[i] = area >= 0 ? b : a;
+	}
+
+	// Ear clipping. Only reflex vertices can be inside an ear; a vertex never turns reflex as ears are cut.
+	std::vector<unsigned char> reflex(n);
+	for (int i = 0; i < n; i++)
+		reflex[i] = ConvexHull2Cross(px, py, prev[i], i, next[i]) <= 0;
+	std::vector<std::vector<unsigned int> > pieces;
+	struct Diagonal { unsigned int a, b; int piece1, piece2; };
+	std::vector<Diagonal> diagonals;
+	std::map<unsigned long long, int> open;  // Diagonal (smaller, larger vertex) to the piece that cut it
+	unsigned int v = 0;
+	for (int remaining = n, tries = 0; remaining >= 3; ) {
+		unsigned int a = prev[v], c = next[v];
+		bool ear = !reflex[v] || tries > remaining;  // Nothing is an ear if the ring is not simple: cut anyway
+		for (unsigned int w = next[c]; ear && tries <= remaining && w != a; w = next[w])
+			if (reflex[w] && Poly2InTriangle(px, py, a, v, c, w) && !(px[w] == px[a] && py[w] == py[a]) &&
+				!(px[w] == px[c] && py[w] == py[c]))
+				ear = false;
+		if (!ear) {
+			v = c;
+			tries++;
+			continue;
+		}
+
+		int piece = static_cast<int>(pieces.size());
+		std::vector<unsigned int> tri(3);
+		tri[0] = a; tri[1] = v; tri[2] = c;
+		pieces.push_back(tri);
+		unsigned int edges[3][2] = { { a, v }, { v, c }, { c, a } };
+		for (int e = 0; e < 3; e++) {
+			unsigned int lo = edges[e][0] < edges[e][1] ? edges[e][0] : edges[e][1];
+			unsigned int hi = edges[e][0] < edges[e][1] ? edges[e][1] : edges[e][0];
+			if (lo + 1 == hi || (lo == 0 && hi == static_cast<unsigned int>(n - 1)))
+				continue;  // Polygon edge
+			unsigned long long key = static_cast<unsigned long long>(lo) << 32 | hi;
+			std::map<unsigned long long, int>::iterator it = open.find(key);
+			if (it == open.end())
+				open[key] = piece;
+			else {
+				Diagonal d = { lo, hi, it->second, piece };
+				diagonals.push_back(d);
+				open.erase(it);
+			}
+		}
+		next[a] = c;
+		prev[c] = a;
+		reflex[a] = ConvexHull2Cross(px, py, prev[a], a, c) <= 0;
+		reflex[c] = ConvexHull2Cross(px, py, a, c, next[c]) <= 0;
+		remaining--;
+		tries = 0;
+		v = a;
+	}
+
+	// Hertel-Mehlhorn: remove diagonals whose ends stay convex. Pieces merge into the earlier one.
+	std::vector<int> parent(pieces.size());
+	for (size_t i = 0; i < parent.size(); i++)
+		parent[i] = static_cast<int>(i);
+	for (size_t d = 0; d < diagonals.size(); d++) {
+		int p = diagonals[d].piece1, q = diagonals[d].piece2;
+		while (parent[p] != p)
+			p = parent[p];
+		while (parent[q] != q)
+			q = parent[q];
+
+		// P holds u -> v, Q holds v -> u; merged ring is P from v around to u, then Q after u up to v
+		std::vector<unsigned int> &pp = pieces[p], &qq = pieces[q];
+		size_t np = pp.size(), nq = qq.size();
+		size_t iu = Poly2FindInPiece(pp, diagonals[d].a), iv = Poly2FindInPiece(pp, diagonals[d].b);
+		if ((iu + 1) % np != iv) {
+			size_t t = iu;
+			iu = iv;
+			iv = t;
+		}
+		unsigned int u = pp[iu], w = pp[iv];
+		size_t ju = Poly2FindInPiece(qq, u), jv = Poly2FindInPiece(qq, w);
+		if (ConvexHull2Cross(px, py, pp[(iu + np - 1) % np], u, qq[(ju + 1) % nq]) < 0 ||
+			ConvexHull2Cross(px, py, qq[(jv + nq - 1) % nq], w, pp[(iv + 1) % np]) < 0)
+			continue;
+		std::vector<unsigned int> merged;
+		merged.reserve(np + nq - 2);
+		for (size_t i = iv; ; i = (i + 1) % np) {
+			merged.push_back(pp[i]);
+			if (i == iu)
+				break;
+		}
+		for (size_t j = (ju + 1) % nq; j != jv; j = (j + 1) % nq)
+			merged.push_back(qq[j]);
+		pp.swap(merged);
+		qq.clear();
+		parent[q] = p;
+	}
+
+	for (size_t k = 0; k < pieces.size(); k++) {
+		if (parent[k] != static_cast<int>(k))
+			continue;
+		const std::vector<unsigned int> &piece = pieces[k];
+		float twiceArea = 0;
+		for (size_t i = 0, j = piece.size() - 1; i < piece.size(); j = i++)
+			twiceArea += px[piece[j]] * py[piece[i]] - px[piece[i]] * py[piece[j]];
+		if (!(twiceArea > 0))
+			continue;  // Slivers of collinear or repeated vertices
+		for (size_t i = 0; i < piece.size(); i++) {
+			pOut->x.push_back(px[piece[i]]);
+			pOut->y.push_back(py[piece[i]]);
+		}
+		pOut->offsets.push_back(static_cast<int>(pOut->x.size()));
+	}
+}
+
+// True if any piece overlaps the convex polygon of n vertices (Cd2NN per piece)
+inline bool Poly2ConvexOverlapN(const Poly2Convex &c, const float *px, const float *py, int n) {
+	for (int p = 0; p < Poly2GetNumPieces(c); p++) {
+		int first = c.offsets[p];
+		if (Cd2NN(&c.x[first], &c.y[first], c.offsets[p + 1] - first, px, py, n))
+			return true;
+	}
+	return false;
+}
+
+}  // namespace
+
+#endif  // _SAW_GEOM_POLY2_INCLUDED
@@ -0,0 +1,348 @@
+// saw_geom_scene2.h - Binary scene container for 2d collision data
+//                    - Structure-of-arrays primitives and prebuilt hierarchies, loaded without parsing
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.00 - 10/19/26 - Initial release
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Builds on saw_geom_cd2.h, saw_geom_bvh2.h, and saw_io.h for streams
+//
+// - Format (version 1), every field a little endian 32-bit word
+//   - Header, 64 bytes: magic "SW2S", version, endian tag 0x01020304, section count, file size
+//     (low, high), reserved
+//   - Section table, 32 bytes per section: kind, param, count, stride, offset (low, high), size
+//     (low, high)
+//   - Section data, each starting on a SCENE2_ALIGN (64) byte boundary:
+//     - SCENE2_SECTION_PRIMS: param is the Prim2Type, count primitives stored as Prim2Info<T>::COMPS
+//       float arrays, stride bytes apart (also 64 byte aligned)
+//     - SCENE2_SECTION_BVH_NODES/INDICES/BOXES: a Bvh2<W> over one primitive type (param), with
+//       stride = W; nodes are stored exactly as Bvh2Node<W>, boxes are the Aabb2 it was built from
+//
+// - Loading
+//   - Scene2Open checks the header and section table of a block already in memory (a mapped file, or
+//     FsLoadBinFile output) and hands out pointers into it; nothing is copied or parsed
+//   - Scene2Load reads a whole saw::Io stream into a Scene2 and opens it; on a big endian host it
+//     swaps every word after reading (Scene2Open on mapped memory needs a little endian host)
+//   - The block must be at least 4 byte aligned (8 for Scene2Load storage) so arrays can be read in place
+//   - Only the header and table are checked; section contents (e.g. hierarchy child indices) are trusted
+//
+// - Writing
+//   - Add sections to a Scene2Builder (Scene2AddPrims, Scene2AddBvh), then Scene2Write through saw::Io
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Requires saw_io.h and saw_job.h; define SAW_IO_IMPLEMENTATION and SAW_JOB_IMPLEMENTATION in one file
+// - Functionality is in sawg:: namespace
+
+#ifndef _SAW_GEOM_SCENE2_INCLUDED
+#define _SAW_GEOM_SCENE2_INCLUDED
+
+#include <string.h>
+#include <vector>
+#include "saw_geom_cd2.h"
+#include "saw_geom_bvh2.h"
+#include "saw_io.h"
+
+namespace sawg {
+
+//-----------------------------------------------------------------------------------------------------------
+// FORMAT
+//-----------------------------------------------------------------------------------------------------------
+
+static const unsigned int SCENE2_MAGIC = 0x53325753;  // "SW2S"
+static const unsigned int SCENE2_VERSION = 1;
+static const unsigned int SCENE2_ENDIAN_TAG = 0x01020304;
+static const size_t SCENE2_ALIGN = 64;
+static const size_t SCENE2_HEADER_WORDS = 16;
+static const size_t SCENE2_SECTION_WORDS = 8;
+
+enum Scene2SectionKind {
+	SCENE2_SECTION_PRIMS = 1,
+	SCENE2_SECTION_BVH_NODES,
+	SCENE2_SECTION_BVH_INDICES,
+	SCENE2_SECTION_BVH_BOXES
+};
+
+struct Scene2Section {
+	unsigned int kind;
+	unsigned int param;
+	unsigned int count;
+	unsigned int stride;
+	unsigned long long offset;
+	unsigned long long size;
+};
+
+inline size_t Scene2AlignUp(size_t at) {
+	return (at + SCENE2_ALIGN - 1) & ~(SCENE2_ALIGN - 1);
+}
+
+inline bool Scene2IsLittleEndian() {
+	unsigned int one = 1;
+	unsigned char b;
+	memcpy(&b, &one, 1);
+	return b == 1;
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// WRITING
+//-----------------------------------------------------------------------------------------------------------
+
+struct Scene2Builder {
+	std::vector<Scene2Section> sections;
+	std::vector<std::vector<unsigned int> > data;  // Words of each section, host order
+};
+
+inline std::vector<unsigned int> &Scene2AddSection(Scene2Builder *pBuilder, unsigned int kind, unsigned int param,
+	unsigned int count, unsigned int stride, size_t words) {
+	Scene2Section s = { kind, param, count, stride, 0, words * 4 };
+	pBuilder->sections.push_back(s);
+	pBuilder->data.push_back(std::vector<unsigned int>(words, 0));
+	return pBuilder->data.back();
+}
+
+// Primitives stored as structure-of-arrays: comps[k] holds count values of the primitive's k-th member
+inline void Scene2AddPrims(Scene2Builder *pBuilder, Prim2Type type, const float *const *comps, size_t count) {
+	size_t stride = Scene2AlignUp(count * 4);
+	std::vector<unsigned int> &words = Scene2AddSection(pBuilder, SCENE2_SECTION_PRIMS, type,
+		static_cast<unsigned int>(count), static_cast<unsigned int>(stride), Prim2GetComps(type) * stride / 4);
+	for (int k = 0; k < Prim2GetComps(type); k++)
+		if (count)
+			memcpy(&words[k * stride / 4], comps[k], count * 4);
+}
+
+// Primitives from an array of structures (Aabb2 *, Triangle2 *, ...)
+template <class T> inline void Scene2AddPrims(Scene2Builder *pBuilder, const T *pPrims, size_t count) {
+	static_assert(sizeof(T) == Prim2Info<T>::COMPS * sizeof(float), "Primitive must be plain floats");
+	std::vector<float> soa(Prim2Info<T>::COMPS * count);
+	const float *comps[PRIM2_MAX_COMPS];
+	for (int k = 0; k < Prim2Info<T>::COMPS; k++) {
+		for (size_t i = 0; i < count; i++)
+			soa[k * count + i] = reinterpret_cast<const float *>(&pPrims[i])[k];
+		comps[k] = count ? &soa[k * count] : 0;
+	}
+	Scene2AddPrims(pBuilder, Prim2Info<T>::TYPE, comps, count);
+}
+
+// Hierarchy over the primitives of one type, with the boxes it was built from
+template <int W> inline void Scene2AddBvh(Scene2Builder *pBuilder, Prim2Type type, const Bvh2<W> &bvh, const Aabb2 *boxes, size_t numBoxes) {
+	static_assert(sizeof(Bvh2Node<W>) == W * 6 * 4, "Node must be plain 32-bit words");
+	std::vector<unsigned int> &nodes = Scene2AddSection(pBuilder, SCENE2_SECTION_BVH_NODES, type,
+		static_cast<unsigned int>(bvh.nodes.size()), W, bvh.nodes.size() * W * 6);
+	if (!bvh.nodes.empty())
+		memcpy(&nodes[0], &bvh.nodes[0], bvh.nodes.size() * sizeof(Bvh2Node<W>));
+	std::vector<unsigned int> &indices = Scene2AddSection(pBuilder, SCENE2_SECTION_BVH_INDICES, type,
+		static_cast<unsigned int>(bvh.indices.size()), W, bvh.indices.size());
+	if (!bvh.indices.empty())
+		memcpy(&indices[0], &bvh.indices[0], bvh.indices.size() * 4);
+	std::vector<unsigned int> &boxWords = Scene2AddSection(pBuilder, SCENE2_SECTION_BVH_BOXES, type,
+		static_cast<unsigned int>(numBoxes), W, numBoxes * 4);
+	if (numBoxes)
+		memcpy(&boxWords[0], boxes, numBoxes * sizeof(Aabb2));
+}
+
+inline void Scene2WriteWords(const saw::Io *io, const unsigned int *words, size_t count) {
+	if (Scene2IsLittleEndian()) {
+		saw::IoWriteRaw(io, count * 4, words);
+		return;
+	}
+	for (size_t i = 0; i < count; i++)
+		saw::IoWrite32le(io, static_cast<int>(words[i]));
+}
+
+inline void Scene2WritePad(const saw::Io *io, size_t bytes) {
+	static const unsigned char zeros[SCENE2_ALIGN] = { 0 };
+	saw::IoWriteRaw(io, bytes, zeros);
+}
+
+inline void Scene2Write(const saw::Io *io, const Scene2Builder &builder) {
+	size_t numSections = builder.sections.size();
+	size_t at = Scene2AlignUp((SCENE2_HEADER_WORDS + SCENE2_SECTION_WORDS * numSections) * 4);
+	std::vector<unsigned int> table;
+	for (size_t i = 0; i < numSections; i++) {
+		const Scene2Section &s = builder.sections[i];
+		unsigned int entry[SCENE2_SECTION_WORDS] = { s.kind, s.param, s.count, s.stride,
+			static_cast<unsigned int>(at), static_cast<unsigned int>(static_cast<unsigned long long>(at) >> 32),
+			static_cast<unsigned int>(s.size), static_cast<unsigned int>(s.size >> 32) };
+		table.insert(table.end(), entry, entry + SCENE2_SECTION_WORDS);
+		at = Scene2AlignUp(at + static_cast<size_t>(s.size));
+	}
+	unsigned int header[SCENE2_HEADER_WORDS] = { SCENE2_MAGIC, SCENE2_VERSION, SCENE2_ENDIAN_TAG,
+		static_cast<unsigned int>(numSections), static_cast<unsigned int>(at),
+		static_cast<unsigned int>(static_cast<unsigned long long>(at) >> 32) };
+	Scene2WriteWords(io, header, SCENE2_HEADER_WORDS);
+	if (!table.empty())
+		Scene2WriteWords(io, &table[0], table.size());
+	size_t written = (SCENE2_HEADER_WORDS + table.size()) * 4;
+	for (size_t i = 0; i < numSections; i++) {
+		Scene2WritePad(io, Scene2AlignUp(written) - written);
+		written = Scene2AlignUp(written);
+		const std::vector<unsigned int> &words = builder.data[i];
+		if (!words.empty())
+			Scene2WriteWords(io, &words[0], words.size());
+		written += words.size() * 4;
+	}
+	Scene2WritePad(io, Scene2AlignUp(written) - written);
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// READING
+//-----------------------------------------------------------------------------------------------------------
+
+// Scene in memory owned elsewhere
+struct Scene2View {
+	const unsigned char *base;
+	size_t size;
+	size_t numSections;
+};
+
+// Scene read from a stream; view points into storage
+struct Scene2 {
+	std::vector<unsigned long long> storage;
+	Scene2View view;
+};
+
+inline unsigned int Scene2Word(const unsigned char *p, size_t word) {
+	unsigned int v;
+	memcpy(&v, p + word * 4, 4);
+	return v;
+}
+
+inline Scene2Section Scene2GetSection(const Scene2View &v, size_t i) {
+	const unsigned char *p = v.base + (SCENE2_HEADER_WORDS + i * SCENE2_SECTION_WORDS) * 4;
+	Scene2Section s;
+	s.kind = Scene2Word(p, 0);
+	s.param = Scene2Word(p, 1);
+	s.count = Scene2Word(p, 2);
+	s.stride = Scene2Word(p, 3);
+	s.offset = Scene2Word(p, 4) | (static_cast<unsigned long long>(Scene2Word(p, 5)) << 32);
+	s.size = Scene2Word(p, 6) | (static_cast<unsigned long long>(Scene2Word(p, 7)) << 32);
+	return s;
+}
+
+// Check the header and section table of a scene in memory (host order words)
+inline bool Scene2Open(const void *pMem, size_t size, Scene2View *pOut) {
+	const unsigned char *base = static_cast<const unsigned char *>(pMem);
+	if (!base || (reinterpret_cast<size_t>(base) & 3) || size < SCENE2_HEADER_WORDS * 4)
+		return false;
+	if (Scene2Word(base, 0) != SCENE2_MAGIC || Scene2Word(base, 1) != SCENE2_VERSION || Scene2Word(base, 2) != SCENE2_ENDIAN_TAG)
+		return false;
+	unsigned long long fileSize = Scene2Word(base, 4) | (static_cast<unsigned long long>(Scene2Word(base, 5)) << 32);
+	size_t numSections = Scene2Word(base, 3);
+	if (fileSize > size || numSections > (size - SCENE2_HEADER_WORDS * 4) / (SCENE2_SECTION_WORDS * 4))
+		return false;
+	Scene2View v = { base, static_cast<size_t>(fileSize), numSections };
+	for (size_t i = 0; i < numSections; i++) {
+		Scene2Section s = Scene2GetSection(v, i);
+		if (s.offset % SCENE2_ALIGN || s.offset > fileSize || s.size > fileSize - s.offset || s.param >= PRIM2_COUNT)
+			return false;
+		unsigned long long need = 0;
+		switch (s.kind) {
+		case SCENE2_SECTION_PRIMS:
+			if (s.stride % SCENE2_ALIGN || static_cast<unsigned long long>(s.count) * 4 > s.stride)
+				return false;
+			need = static_cast<unsigned long long>(Prim2GetComps(static_cast<Prim2Type>(s.param))) * s.stride;
+			break;
+		case SCENE2_SECTION_BVH_NODES: need = static_cast<unsigned long long>(s.count) * s.stride * 6 * 4; break;
+		case SCENE2_SECTION_BVH_INDICES: need = static_cast<unsigned long long>(s.count) * 4; break;
+		case SCENE2_SECTION_BVH_BOXES: need = static_cast<unsigned long long>(s.count) * 16; break;
+		default: break;  // Unknown kinds are skipped
+		}
+		if (need > s.size)
+			return false;
+	}
+	*pOut = v;
+	return true;
+}
+
+// Read a whole scene from a stream and open it
+inline bool Scene2Load(const saw::Io *io, Scene2 *pOut) {
+	unsigned int header[SCENE2_HEADER_WORDS];
+	if (!saw::IoReadRaw(io, sizeof(header), header))
+		return false;
+	bool swap = !Scene2IsLittleEndian();
+	if (swap)
+		saw::ByteSwapBuf32(header, SCENE2_HEADER_WORDS);
+	unsigned long long fileSize = header[4] | (static_cast<unsigned long long>(header[5]) << 32);
+	if (header[0] != SCENE2_MAGIC || fileSize < sizeof(header) || fileSize > static_cast<size_t>(-1))
+		return false;
+	pOut->storage.resize((static_cast<size_t>(fileSize) + 7) / 8);
+	unsigned char *p = reinterpret_cast<unsigned char *>(&pOut->storage[0]);
+	memcpy(p, header, sizeof(header));
+	if (!saw::IoReadRaw(io, static_cast<size_t>(fileSize) - sizeof(header), p + sizeof(header)))
+		return false;
+	if (swap)
+		saw::ByteSwapBuf32(p + sizeof(header), (static_cast<size_t>(fileSize) - sizeof(header)) / 4);
+	return Scene2Open(p, static_cast<size_t>(fileSize), &pOut->view);
+}
+
+inline bool Scene2Find(const Scene2View &v, unsigned int kind, Prim2Type type, Scene2Section *pOut) {
+	for (size_t i = 0; i < v.numSections; i++) {
+		Scene2Section s = Scene2GetSection(v, i);
+		if (s.kind == kind && s.param == static_cast<unsigned int>(type)) {
+			*pOut = s;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Structure-of-arrays primitives of a type: comps[k] points at count values of the k-th member
+struct Scene2Prims {
+	const float *comps[PRIM2_MAX_COMPS];
+	size_t count;
+};
+
+inline bool Scene2GetPrims(const Scene2View &v, Prim2Type type, Scene2Prims *pOut) {
+	Scene2Section s;
+	if (!Scene2Find(v, SCENE2_SECTION_PRIMS, type, &s))
+		return false;
+	for (int k = 0; k < PRIM2_MAX_COMPS; k++)
+		pOut->comps[k] = k < Prim2GetComps(type) ? reinterpret_cast<const float *>(v.base + s.offset + static_cast<size_t>(k) * s.stride) : 0;
+	pOut->count = s.count;
+	return true;
+}
+
+// Hierarchy over the primitives of a type, and the boxes it was built from
+template <int W> inline bool Scene2GetBvh(const Scene2View &v, Prim2Type type, Bvh2View<W> *pOut, const Aabb2 **ppBoxes) {
+	Scene2Section nodes, indices, boxes;
+	if (!Scene2Find(v, SCENE2_SECTION_BVH_NODES, type, &nodes) || nodes.stride != W ||
+		!Scene2Find(v, SCENE2_SECTION_BVH_INDICES, type, &indices) || !Scene2Find(v, SCENE2_SECTION_BVH_BOXES, type, &boxes))
+		return false;
+	pOut->nodes = reinterpret_cast<const Bvh2Node<W> *>(v.base + nodes.offset);
+	pOut->numNodes = nodes.count;
+	pOut->indices = reinterpret_cast<const unsigned int *>(v.base + indices.offset);
+	pOut->numIndices = indices.count;
+	*ppBoxes = reinterpret_cast<const Aabb2 *>(v.base + boxes.offset);
+	pOut->bounds = Bvh2EmptyBox();
+	for (size_t i = 0; pOut->numNodes && i < W; i++)
+		if (pOut->nodes[0].child[i] != BVH2_EMPTY || pOut->nodes[0].count[i])
+			Bvh2Grow(&pOut->bounds, Aabb2(pOut->nodes[0].minX[i], pOut->nodes[0].minY[i], pOut->nodes[0].maxX[i], pOut->nodes[0].maxY[i]));
+	return true;
+}
+
+}  // namespace
+
+#endif  // _SAW_GEOM_SCENE2_INCLUDED
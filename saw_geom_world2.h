@@ -0,0 +1,1380 @@
+// saw_geom_world2.h - Collision pipeline for 2d primitives
+//                    - Parallel narrowphase over candidate pair lists
+//                    - World container with generational handles and per-type SoA storage
+//                    - Persistent contact cache with begin/stay/end events
+//                    - Sweep and prune broadphase with category/mask filtering
+//                    - Morton order sorting of pools
+//                    - Lock-free snapshots for query threads
+//                    - Incremental view queries reporting entered and exited primitives
+//                    - Snapshot and rollback of world state with page deltas
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.11 - 10/19/26 - World2Rollback keeps each array in its own page aligned region; saves copy only changed
+//                      pages and older frames are restored by undoing pages
+// - v1.10 - 10/19/26 - Added World2Rollback: frames of world, contact cache and hierarchy state restored by copy
+// - v1.09 - 10/19/26 - Timing probes (saw_prof.h) on the pipeline stages
+// - v1.08 - 10/19/26 - Capsule2 in the pair tables
+// - v1.07 - 10/19/26 - Added World2View: incremental rectangle queries on snapshots with entered/exited lists
+// - v1.06 - 10/19/26 - Narrowphase uses the generic Cd2 from saw_geom_cd2.h in place of Cd2NarrowTest
+// - v1.05 - 10/19/26 - Added World2Snapshots: published epochs of bounds and hierarchy, pinned without locks
+// - v1.04 - 10/19/26 - Added World2SortMorton
+// - v1.03 - 10/19/26 - Added bounds and category/mask filter per primitive
+//                    - Added World2FindPairs and World2QueryAabb
+// - v1.02 - 10/19/26 - Added Contact2Cache
+// - v1.01 - 10/19/26 - Added World2 container and type pair dispatch table
+// - v1.00 - 10/19/26 - Initial release: parallel narrowphase over candidate pair lists
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Builds on saw_geom_cd2.h for the tests, saw_geom_bvh2.h for spatial ordering and saw_job.h for threads
+// - With SAW_PROF defined, each stage (World2SortMorton, World2FindPairs, Cd2NarrowPhase and its tasks,
+//   Contact2CacheUpdate, World2Publish, World2ViewUpdate, World2RollbackSave, World2RollbackRestore) records
+//   a saw_prof.h timing probe under its name
+// - Primitive arrays are read through Prim2View, which covers both arrays of primitives (Aabb2 *)
+//   and structure-of-arrays storage (separate minX, minY, ... arrays)
+// - Primitives are referenced by Prim2Ref, a (type, index) pair packed in 32 bits
+//
+// - Narrowphase
+//   - Pairs are bucketed by type pair, so each batch calls exactly one (inlined) Cd2 test
+//   - Batches are cut into tasks for a JobPool. Each worker appends hits to its own buffer, and the
+//     buffers are merged in task order, so output is identical for any number of threads.
+//
+// - World
+//   - Owns primitives in one structure-of-arrays pool per type, always densely packed
+//   - World2Handle is stable for the life of a primitive: a slot index plus an 8-bit generation that
+//     is bumped on remove, so stale handles are rejected
+//   - Remove swaps the last primitive of the pool into the hole and remaps its slot, both O(1)
+//   - Prim2Ref indices (World2GetRef) are only stable until the next remove of that type
+//   - World2SortMorton reorders a pool by the Morton key of its bounds centers (saw_geom_bvh2.h), so
+//     neighbours in space are neighbours in memory. Handles stay valid; Prim2Refs are remapped.
+//   - Every primitive also stores its bounds and a 32-bit category and mask. Two primitives can only
+//     pair if each one's category shares a bit with the other's mask (default category 1, mask all).
+//
+// - Broadphase
+//   - World2FindPairs sorts bounds on x and sweeps; World2QueryAabb scans the bounds of every pool
+//   - Both test 4 candidates at a time with SSE2, applying the category/mask filter together with
+//     the bounds overlap, so filtered pairs never reach the narrowphase
+//   - Pairs come out as World2GetRef references, ready for Cd2NarrowPhase
+//
+// - Contact cache
+//   - Remembers which handle pairs touched last update, in an open addressing table keyed by the pair
+//   - Each update is Contact2CacheBegin, Contact2CacheTouch for every colliding pair, Contact2CacheEnd
+//     (or Contact2CacheUpdate straight from Cd2NarrowPhase output)
+//   - Produces begin, stay and end event lists; pairs are reported with the lower handle first
+//   - Only the table grows (at half load); a steady state does not allocate
+//   - Removed handles simply stop being touched, so their contacts end on the next update
+//
+// - Snapshots
+//   - World2Publish (simulation thread) copies every primitive's handle, bounds and filter and builds a
+//     Bvh2<4> over them, into a buffer no reader holds, then swaps it in as the current epoch
+//   - Readers World2SnapshotPin the current epoch, query it as long as they like, then Unpin. Pinning
+//     is an atomic increment and a recheck; neither side ever waits for the other.
+//   - Buffers are reused (triple buffering when readers keep up). If readers hold them all the writer
+//     adds one; spare buffers past World2Snapshots::numSpare have their memory released once unpinned.
+//   - A snapshot is immutable and independent of the world, so the world can change while it is read
+//
+// - View queries
+//   - World2View keeps the handles overlapping a rectangle; World2ViewUpdate moves it and fills entered
+//     and exited, so a renderer or interest manager never sees the unchanged handles again
+//   - On the snapshot epoch of the last update, nothing has moved but the view: only the strips of the new
+//     rectangle outside the old one (up to 4) and the reverse are queried through the snapshot's Bvh2, and
+//     a handle counts as entered (exited) only if it overlaps the new (old) rectangle and not the other
+//   - On a new epoch or filter the whole rectangle is queried and compared to the members, which is
+//     linear in the members but still only reports the changes
+//   - Membership is looked up by world slot, so a view holds 4 bytes per world slot besides its members
+//
+// - Rollback
+//   - World2Rollback mirrors the world (and optionally a Contact2Cache and a Bvh2<4>) in one image, where
+//     every array has its own page aligned region with room to grow, so the layout stays put as sizes change
+//   - World2RollbackSave compares each array with its region and copies only the 4K pages that differ,
+//     keeping their old contents with the frame. Adding or removing a primitive touches the last page of
+//     its pool's arrays and of the slots, not everything after them.
+//   - An array that outgrows its region moves to a new one at the end of the image, 1.5 times its size
+//   - World2RollbackRestore puts back the old contents of the pages saved since the frame (newest first),
+//     then copies every array out of the image: proportional to the state and the pages changed, and
+//     nothing is rebuilt
+//   - Past numFrames the oldest frame is forgotten; vectors keep their capacity, so a steady state does
+//     not allocate
+//   - Regions hold raw bytes, so they are only meant for the same build on the same machine
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Requires saw_job.h; define SAW_JOB_IMPLEMENTATION in one file
+// - With SAW_PROF defined, also define SAW_PROF_IMPLEMENTATION (saw_prof.h) in one file
+// - Functionality is in sawg:: namespace
+
+#ifndef _SAW_GEOM_WORLD2_INCLUDED
+#define _SAW_GEOM_WORLD2_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <vector>
+#include "saw_geom_cd2.h"
+#include "saw_geom_bvh2.h"
+#include "saw_job.h"
+#include "saw_prof.h"
+
+namespace sawg {
+
+//-----------------------------------------------------------------------------------------------------------
+// PRIMITIVE REFERENCES AND VIEWS
+//-----------------------------------------------------------------------------------------------------------
+
+// Primitive reference: type in the top 4 bits, index in the low 28
+typedef unsigned int Prim2Ref;
+
+inline Prim2Ref Prim2MakeRef(Prim2Type type, unsigned int index) { return (static_cast<unsigned int>(type) << 28) | index; }
+inline Prim2Type Prim2RefType(Prim2Ref ref) { return static_cast<Prim2Type>(ref >> 28); }
+inline unsigned int Prim2RefIndex(Prim2Ref ref) { return ref & 0x0fffffff; }
+
+//-----------------------------------------------------------------------------------------------------------
+struct Cd2Pair {
+	Prim2Ref a, b;
+	Cd2Pair() { }
+	Cd2Pair(Prim2Ref a, Prim2Ref b) : a(a), b(b) { }
+};
+
+//-----------------------------------------------------------------------------------------------------------
+// Strided view of an array of primitives of one type
+// Float i of primitive n is comps[i][n * stride].
+struct Prim2View {
+	const float *comps[PRIM2_MAX_COMPS];
+	size_t stride;  // In floats
+	size_t count;
+};
+
+// View an array of primitives (Aabb2 *, Circle2 *, ...)
+template <class T> inline Prim2View Prim2ViewAos(const T *pPrims, size_t count) {
+	const float *pBase = reinterpret_cast<const float *>(pPrims);
+	Prim2View view;
+	for (int i = 0; i < PRIM2_MAX_COMPS; i++)
+		view.comps[i] = i < Prim2Info<T>::COMPS ? pBase + i : 0;
+	view.stride = Prim2Info<T>::COMPS;
+	view.count = count;
+	return view;
+}
+
+// View structure-of-arrays storage; comps holds one array per float of the primitive
+inline Prim2View Prim2ViewSoa(const float *const *comps, int numComps, size_t count) {
+	Prim2View view;
+	for (int i = 0; i < PRIM2_MAX_COMPS; i++)
+		view.comps[i] = i < numComps ? comps[i] : 0;
+	view.stride = 1;
+	view.count = count;
+	return view;
+}
+
+// Empty view, for types a caller has none of
+inline Prim2View Prim2ViewEmpty() {
+	return Prim2ViewSoa(0, 0, 0);
+}
+
+template <class T> inline T Prim2Load(const Prim2View &view, size_t index) {
+	static_assert(sizeof(T) == Prim2Info<T>::COMPS * sizeof(float), "Primitive must be plain floats");
+	T prim;
+	float *p = reinterpret_cast<float *>(&prim);
+	size_t at = index * view.stride;
+	for (int i = 0; i < Prim2Info<T>::COMPS; i++)
+		p[i] = view.comps[i][at];
+	return prim;
+}
+
+// Initializer for a [type of a][type of b] table of instantiations of F<A, B>
+#define SAW_PRIM2_PAIR_TABLE_ROW(F, A) \
+	{ F<A, Point2>, F<A, Aabb2>, F<A, Obb2>, F<A, LineSeg2>, F<A, Triangle2>, F<A, Circle2>, F<A, Capsule2> }
+#define SAW_PRIM2_PAIR_TABLE(F) { \
+	SAW_PRIM2_PAIR_TABLE_ROW(F, Point2), SAW_PRIM2_PAIR_TABLE_ROW(F, Aabb2), SAW_PRIM2_PAIR_TABLE_ROW(F, Obb2), \
+	SAW_PRIM2_PAIR_TABLE_ROW(F, LineSeg2), SAW_PRIM2_PAIR_TABLE_ROW(F, Triangle2), SAW_PRIM2_PAIR_TABLE_ROW(F, Circle2), \
+	SAW_PRIM2_PAIR_TABLE_ROW(F, Capsule2) }
+
+//-----------------------------------------------------------------------------------------------------------
+// NARROWPHASE
+//-----------------------------------------------------------------------------------------------------------
+
+// Test one primitive of each view
+template <class A, class B>
+inline bool Cd2ViewTest(const Prim2View &viewA, size_t indexA, const Prim2View &viewB, size_t indexB) {
+	return Cd2(Prim2Load<A>(viewA, indexA), Prim2Load<B>(viewB, indexB));
+}
+
+typedef bool(*Cd2ViewFunc)(const Prim2View &, size_t, const Prim2View &, size_t);
+
+// Test function for a type pair, covering the whole Cd2 matrix
+inline Cd2ViewFunc Cd2GetViewTest(Prim2Type a, Prim2Type b) {
+	static const Cd2ViewFunc table[PRIM2_COUNT][PRIM2_COUNT] = SAW_PRIM2_PAIR_TABLE(Cd2ViewTest);
+	return table[a][b];
+}
+
+// Test pairs order[begin..end-1], all of type A vs type B, appending hit pair indices
+template <class A, class B>
+inline void Cd2NarrowBatch(const Prim2View &viewA, const Prim2View &viewB, const Cd2Pair *pairs,
+	const unsigned int *order, size_t begin, size_t end, std::vector<unsigned int> *pHits) {
+	for (size_t i = begin; i < end; i++) {
+		const Cd2Pair &pair = pairs[order[i]];
+		if (Cd2(Prim2Load<A>(viewA, Prim2RefIndex(pair.a)), Prim2Load<B>(viewB, Prim2RefIndex(pair.b))))
+			pHits->push_back(order[i]);
+	}
+}
+
+typedef void(*Cd2NarrowBatchFunc)(const Prim2View &, const Prim2View &, const Cd2Pair *,
+	const unsigned int *, size_t, size_t, std::vector<unsigned int> *);
+
+// Batch function for a type pair
+inline Cd2NarrowBatchFunc Cd2NarrowGetBatch(Prim2Type a, Prim2Type b) {
+	static const Cd2NarrowBatchFunc table[PRIM2_COUNT][PRIM2_COUNT] = SAW_PRIM2_PAIR_TABLE(Cd2NarrowBatch);
+	return table[a][b];
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// Buffers reused between Cd2NarrowPhase calls, so a steady state does not allocate
+struct Cd2NarrowScratch {
+	std::vector<unsigned int> order;        // Pair indices bucketed by type pair
+	std::vector<size_t> taskBegin;          // Range of order for each task, plus an end marker
+	std::vector<int> taskKey;               // Type pair of each task (a * PRIM2_COUNT + b)
+	std::vector<int> taskWorker;            // Worker that ran each task
+	std::vector<size_t> taskHitBegin;       // Where each task's hits start in its worker's buffer
+	std::vector<size_t> taskHitCount;
+	std::vector<std::vector<unsigned int> > workerHits;
+};
+
+struct Cd2NarrowJob {
+	const Prim2View *views;
+	const Cd2Pair *pairs;
+	Cd2NarrowScratch *pScratch;
+};
+
+inline void Cd2NarrowTask(size_t task, int worker, void *user) {
+	SAW_PROF_SCOPE("Cd2NarrowTask");
+	Cd2NarrowJob *pJob = static_cast<Cd2NarrowJob *>(user);
+	Cd2NarrowScratch *pScratch = pJob->pScratch;
+	std::vector<unsigned int> *pHits = &pScratch->workerHits[worker];
+	Prim2Type a = static_cast<Prim2Type>(pScratch->taskKey[task] / PRIM2_COUNT);
+	Prim2Type b = static_cast<Prim2Type>(pScratch->taskKey[task] % PRIM2_COUNT);
+	pScratch->taskWorker[task] = worker;
+	pScratch->taskHitBegin[task] = pHits->size();
+	Cd2NarrowGetBatch(a, b)(pJob->views[a], pJob->views[b], pJob->pairs, &pScratch->order[0],
+		pScratch->taskBegin[task], pScratch->taskBegin[task + 1], pHits);
+	pScratch->taskHitCount[task] = pHits->size() - pScratch->taskHitBegin[task];
+}
+
+// Test every pair, views[type] supplying the primitives of each type.
+// pHits receives the indices (into pairs) of colliding pairs, grouped by type pair in PRIM2_* order
+// and in input order within a group. grain is the most pairs per task; pool may be null.
+inline void Cd2NarrowPhase(saw::JobPool *pool, const Prim2View *views, const Cd2Pair *pairs, size_t count,
+	std::vector<unsigned int> *pHits, Cd2NarrowScratch *pScratch, size_t grain = 1024) {
+	SAW_PROF_SCOPE("Cd2NarrowPhase");
+	pHits->clear();
+	if (count == 0)
+		return;
+	if (grain == 0)
+		grain = 1;
+
+	// Counting sort pairs by type pair
+	const int NUM_KEYS = PRIM2_COUNT * PRIM2_COUNT;
+	size_t bucket[NUM_KEYS + 1] = { 0 };
+	for (size_t i = 0; i < count; i++)
+		bucket[Prim2RefType(pairs[i].a) * PRIM2_COUNT + Prim2RefType(pairs[i].b) + 1]++;
+	for (int k = 0; k < NUM_KEYS; k++)
+		bucket[k + 1] += bucket[k];
+	pScratch->order.resize(count);
+	size_t next[NUM_KEYS];
+	for (int k = 0; k < NUM_KEYS; k++)
+		next[k] = bucket[k];
+	for (size_t i = 0; i < count; i++)
+		pScratch->order[next[Prim2RefType(pairs[i].a) * PRIM2_COUNT + Prim2RefType(pairs[i].b)]++] = static_cast<unsigned int>(i);
+
+	// Cut each bucket into tasks
+	pScratch->taskBegin.clear();
+	pScratch->taskKey.clear();
+	for (int k = 0; k < NUM_KEYS; k++) {
+		for (size_t at = bucket[k]; at < bucket[k + 1]; at += grain) {
+			pScratch->taskBegin.push_back(at);
+			pScratch->taskKey.push_back(k);
+		}
+	}
+	size_t numTasks = pScratch->taskKey.size();
+	pScratch->taskBegin.push_back(count);
+	pScratch->taskWorker.resize(numTasks);
+	pScratch->taskHitBegin.resize(numTasks);
+	pScratch->taskHitCount.resize(numTasks);
+	int numWorkers = saw::JobPoolGetWorkers(pool);
+	if (pScratch->workerHits.size() < static_cast<size_t>(numWorkers))
+		pScratch->workerHits.resize(numWorkers);
+	for (int i = 0; i < numWorkers; i++)
+		pScratch->workerHits[i].clear();
+
+	Cd2NarrowJob job = { views, pairs, pScratch };
+	saw::JobPoolFor(pool, numTasks, Cd2NarrowTask, &job);
+
+	// Merge in task order
+	for (size_t t = 0; t < numTasks; t++) {
+		if (pScratch->taskHitCount[t] == 0)
+			continue;
+		const unsigned int *pBegin = &pScratch->workerHits[pScratch->taskWorker[t]][0] + pScratch->taskHitBegin[t];
+		pHits->insert(pHits->end(), pBegin, pBegin + pScratch->taskHitCount[t]);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// WORLD
+//-----------------------------------------------------------------------------------------------------------
+
+// Slot index in the low 24 bits, generation (never 0) in the high 8. 0 is never a valid handle.
+typedef unsigned int World2Handle;
+
+static const World2Handle WORLD2_NULL = 0;
+static const unsigned int WORLD2_MAX_SLOTS = 1 << 24;
+
+struct World2Slot {
+	unsigned int gen;    // Generation of the current (or next, if free) primitive in this slot
+	Prim2Type type;
+	unsigned int index;  // Index in the type's pool, or next free slot if free
+	bool used;
+};
+
+// Structure-of-arrays storage for all primitives of one type
+struct World2Pool {
+	int numComps;
+	std::vector<float> comps[PRIM2_MAX_COMPS];
+	std::vector<float> bounds[4];       // minX, minY, maxX, maxY
+	std::vector<unsigned int> category;
+	std::vector<unsigned int> mask;
+	std::vector<World2Handle> handles;  // Owner of each primitive, to remap on swap-remove
+};
+
+static const unsigned int WORLD2_DEFAULT_CATEGORY = 1;
+static const unsigned int WORLD2_DEFAULT_MASK = 0xffffffff;
+
+struct World2 {
+	World2Pool pools[PRIM2_COUNT];
+	std::vector<World2Slot> slots;
+	unsigned int freeHead;  // First free slot, or WORLD2_MAX_SLOTS if none
+	World2() {
+		for (int i = 0; i < PRIM2_COUNT; i++)
+			pools[i].numComps = Prim2GetComps(static_cast<Prim2Type>(i));
+		freeHead = WORLD2_MAX_SLOTS;
+	}
+};
+
+inline unsigned int World2HandleSlot(World2Handle h) { return h & (WORLD2_MAX_SLOTS - 1); }
+inline unsigned int World2HandleGen(World2Handle h) { return h >> 24; }
+
+inline bool World2IsValid(const World2 *w, World2Handle h) {
+	unsigned int slot = World2HandleSlot(h);
+	return slot < w->slots.size() && w->slots[slot].used && w->slots[slot].gen == World2HandleGen(h);
+}
+
+// Add any primitive. Returns WORLD2_NULL if the world is full.
+template <class T> inline World2Handle World2Add(World2 *w, const T &prim) {
+	static_assert(sizeof(T) == Prim2Info<T>::COMPS * sizeof(float), "Primitive must be plain floats");
+	unsigned int slot = w->freeHead;
+	if (slot == WORLD2_MAX_SLOTS) {
+		if (w->slots.size() >= WORLD2_MAX_SLOTS)
+			return WORLD2_NULL;
+		World2Slot fresh = World2Slot();  // Value initialized, so padding is zero and equal slots compare equal
+		fresh.gen = 1;
+		fresh.type = PRIM2_POINT;
+		w->slots.push_back(fresh);
+		slot = static_cast<unsigned int>(w->slots.size() - 1);
+	}
+	else
+		w->freeHead = w->slots[slot].index;
+
+	World2Pool &pool = w->pools[Prim2Info<T>::TYPE];
+	const float *p = reinterpret_cast<const float *>(&prim);
+	for (int i = 0; i < Prim2Info<T>::COMPS; i++)
+		pool.comps[i].push_back(p[i]);
+	Aabb2 bounds = CalcAabb2(prim);
+	pool.bounds[0].push_back(bounds.minX);
+	pool.bounds[1].push_back(bounds.minY);
+	pool.bounds[2].push_back(bounds.maxX);
+	pool.bounds[3].push_back(bounds.maxY);
+	pool.category.push_back(WORLD2_DEFAULT_CATEGORY);
+	pool.mask.push_back(WORLD2_DEFAULT_MASK);
+	World2Slot &s = w->slots[slot];
+	World2Handle h = (s.gen << 24) | slot;
+	s.type = Prim2Info<T>::TYPE;
+	s.index = static_cast<unsigned int>(pool.handles.size());
+	s.used = true;
+	pool.handles.push_back(h);
+	return h;
+}
+
+// Remove a primitive; the last primitive of its type moves into its place
+inline bool World2Remove(World2 *w, World2Handle h) {
+	if (!World2IsValid(w, h))
+		return false;
+	World2Slot &s = w->slots[World2HandleSlot(h)];
+	World2Pool &pool = w->pools[s.type];
+	unsigned int last = static_cast<unsigned int>(pool.handles.size() - 1);
+	if (s.index != last) {
+		for (int i = 0; i < pool.numComps; i++)
+			pool.comps[i][s.index] = pool.comps[i][last];
+		for (int i = 0; i < 4; i++)
+			pool.bounds[i][s.index] = pool.bounds[i][last];
+		pool.category[s.index] = pool.category[last];
+		pool.mask[s.index] = pool.mask[last];
+		World2Handle moved = pool.handles[last];
+		pool.handles[s.index] = moved;
+		w->slots[World2HandleSlot(moved)].index = s.index;
+	}
+	for (int i = 0; i < pool.numComps; i++)
+		pool.comps[i].pop_back();
+	for (int i = 0; i < 4; i++)
+		pool.bounds[i].pop_back();
+	pool.category.pop_back();
+	pool.mask.pop_back();
+	pool.handles.pop_back();
+
+	s.used = false;
+	s.gen = (s.gen & 0xff) == 0xff ? 1 : s.gen + 1;
+	s.index = w->freeHead;
+	w->freeHead = World2HandleSlot(h);
+	return true;
+}
+
+inline void World2Clear(World2 *w) {
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		for (int i = 0; i < w->pools[t].numComps; i++)
+			w->pools[t].comps[i].clear();
+		for (int i = 0; i < 4; i++)
+			w->pools[t].bounds[i].clear();
+		w->pools[t].category.clear();
+		w->pools[t].mask.clear();
+		w->pools[t].handles.clear();
+	}
+	w->slots.clear();
+	w->freeHead = WORLD2_MAX_SLOTS;
+}
+
+// Type of a valid handle
+inline Prim2Type World2GetType(const World2 *w, World2Handle h) {
+	return w->slots[World2HandleSlot(h)].type;
+}
+
+// (type, index) of a valid handle, until the next remove of that type
+inline Prim2Ref World2GetRef(const World2 *w, World2Handle h) {
+	const World2Slot &s = w->slots[World2HandleSlot(h)];
+	return Prim2MakeRef(s.type, s.index);
+}
+
+inline World2Handle World2RefToHandle(const World2 *w, Prim2Ref ref) {
+	return w->pools[Prim2RefType(ref)].handles[Prim2RefIndex(ref)];
+}
+
+inline size_t World2GetCount(const World2 *w, Prim2Type type) {
+	return w->pools[type].handles.size();
+}
+
+// Get a primitive; fails if the handle is stale or of another type
+template <class T> inline bool World2Get(const World2 *w, World2Handle h, T *pOut) {
+	if (!World2IsValid(w, h) || World2GetType(w, h) != Prim2Info<T>::TYPE)
+		return false;
+	const World2Pool &pool = w->pools[Prim2Info<T>::TYPE];
+	float *p = reinterpret_cast<float *>(pOut);
+	unsigned int index = w->slots[World2HandleSlot(h)].index;
+	for (int i = 0; i < Prim2Info<T>::COMPS; i++)
+		p[i] = pool.comps[i][index];
+	return true;
+}
+
+// Replace a primitive with one of the same type
+template <class T> inline bool World2Set(World2 *w, World2Handle h, const T &prim) {
+	if (!World2IsValid(w, h) || World2GetType(w, h) != Prim2Info<T>::TYPE)
+		return false;
+	World2Pool &pool = w->pools[Prim2Info<T>::TYPE];
+	const float *p = reinterpret_cast<const float *>(&prim);
+	unsigned int index = w->slots[World2HandleSlot(h)].index;
+	for (int i = 0; i < Prim2Info<T>::COMPS; i++)
+		pool.comps[i][index] = p[i];
+	Aabb2 bounds = CalcAabb2(prim);
+	pool.bounds[0][index] = bounds.minX;
+	pool.bounds[1][index] = bounds.minY;
+	pool.bounds[2][index] = bounds.maxX;
+	pool.bounds[3][index] = bounds.maxY;
+	return true;
+}
+
+inline bool World2GetBounds(const World2 *w, World2Handle h, Aabb2 *pOut) {
+	if (!World2IsValid(w, h))
+		return false;
+	const World2Slot &s = w->slots[World2HandleSlot(h)];
+	const World2Pool &pool = w->pools[s.type];
+	*pOut = Aabb2(pool.bounds[0][s.index], pool.bounds[1][s.index], pool.bounds[2][s.index], pool.bounds[3][s.index]);
+	return true;
+}
+
+// Pair only with primitives whose category shares a bit with mask, and whose mask shares a bit with category
+inline bool World2SetFilter(World2 *w, World2Handle h, unsigned int category, unsigned int mask) {
+	if (!World2IsValid(w, h))
+		return false;
+	const World2Slot &s = w->slots[World2HandleSlot(h)];
+	w->pools[s.type].category[s.index] = category;
+	w->pools[s.type].mask[s.index] = mask;
+	return true;
+}
+
+inline bool World2GetFilter(const World2 *w, World2Handle h, unsigned int *pCategory, unsigned int *pMask) {
+	if (!World2IsValid(w, h))
+		return false;
+	const World2Slot &s = w->slots[World2HandleSlot(h)];
+	*pCategory = w->pools[s.type].category[s.index];
+	*pMask = w->pools[s.type].mask[s.index];
+	return true;
+}
+
+inline bool World2CanPair(unsigned int categoryA, unsigned int maskA, unsigned int categoryB, unsigned int maskB) {
+	return (categoryA & maskB) != 0 && (categoryB & maskA) != 0;
+}
+
+// View of one pool, valid until the pool is next added to or removed from
+inline Prim2View World2GetView(const World2 *w, Prim2Type type) {
+	const World2Pool &pool = w->pools[type];
+	const float *comps[PRIM2_MAX_COMPS] = { 0 };
+	for (int i = 0; i < pool.numComps; i++)
+		comps[i] = pool.comps[i].empty() ? 0 : &pool.comps[i][0];
+	return Prim2ViewSoa(comps, pool.numComps, pool.handles.size());
+}
+
+// Views of every pool, ie for Cd2NarrowPhase with pairs of World2GetRef references
+inline void World2GetViews(const World2 *w, Prim2View *pViews) {
+	for (int t = 0; t < PRIM2_COUNT; t++)
+		pViews[t] = World2GetView(w, static_cast<Prim2Type>(t));
+}
+
+// Collision detection between two valid handles of any types
+inline bool World2Test(const World2 *w, World2Handle a, World2Handle b) {
+	const World2Slot &sa = w->slots[World2HandleSlot(a)];
+	const World2Slot &sb = w->slots[World2HandleSlot(b)];
+	return Cd2GetViewTest(sa.type, sb.type)(World2GetView(w, sa.type), sa.index, World2GetView(w, sb.type), sb.index);
+}
+
+// Buffers reused between World2SortMorton calls
+struct World2SortScratch {
+	std::vector<float> cx, cy;
+	std::vector<unsigned int> keys;
+	std::vector<unsigned int> perm;
+	std::vector<float> tempFloats;
+	std::vector<unsigned int> tempUints;
+	Morton2Scratch sort;
+};
+
+// Reorder a pool into Morton order of its bounds centers. Handles stay valid.
+// If pPerm is given it receives the permutation: the primitive now at index i was at (*pPerm)[i].
+// pool may be null.
+inline void World2SortMorton(World2 *w, saw::JobPool *pool, Prim2Type type, World2SortScratch *pScratch,
+	std::vector<unsigned int> *pPerm = 0) {
+	SAW_PROF_SCOPE("World2SortMorton");
+	World2Pool &p = w->pools[type];
+	World2SortScratch &s = *pScratch;
+	size_t n = p.handles.size();
+	if (pPerm)
+		pPerm->clear();
+	if (n == 0)
+		return;
+	s.cx.resize(n);
+	s.cy.resize(n);
+	s.keys.resize(n);
+	s.perm.resize(n);
+	Aabb2 range(1E+37f, 1E+37f, -1E+37f, -1E+37f);
+	for (size_t i = 0; i < n; i++) {
+		s.cx[i] = (p.bounds[0][i] + p.bounds[2][i]) * .5f;
+		s.cy[i] = (p.bounds[1][i] + p.bounds[3][i]) * .5f;
+		if (s.cx[i] < range.minX) range.minX = s.cx[i];
+		if (s.cy[i] < range.minY) range.minY = s.cy[i];
+		if (s.cx[i] > range.maxX) range.maxX = s.cx[i];
+		if (s.cy[i] > range.maxY) range.maxY = s.cy[i];
+	}
+	Morton2CalcKeys(&s.cx[0], &s.cy[0], n, range, &s.keys[0]);
+	Morton2Sort(pool, &s.keys[0], n, &s.perm[0], &s.sort);
+
+	const unsigned int *perm = &s.perm[0];
+	for (int i = 0; i < p.numComps; i++)
+		Morton2Permute(&p.comps[i], perm, &s.tempFloats);
+	for (int i = 0; i < 4; i++)
+		Morton2Permute(&p.bounds[i], perm, &s.tempFloats);
+	Morton2Permute(&p.category, perm, &s.tempUints);
+	Morton2Permute(&p.mask, perm, &s.tempUints);
+	Morton2Permute(&p.handles, perm, &s.tempUints);
+	for (size_t i = 0; i < n; i++)
+		w->slots[World2HandleSlot(p.handles[i])].index = static_cast<unsigned int>(i);
+	if (pPerm)
+		pPerm->assign(s.perm.begin(), s.perm.end());
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// BROADPHASE
+//-----------------------------------------------------------------------------------------------------------
+
+// Buffers reused between World2FindPairs calls
+struct World2PairScratch {
+	std::vector<unsigned long long> sortKeys;  // Sortable minX in the high 32 bits, proxy in the low 32
+	std::vector<float> minX, minY, maxX, maxY;  // Sorted on minX, padded with 3 entries that never pair
+	std::vector<unsigned int> category, mask;
+	std::vector<Prim2Ref> refs;
+	std::vector<Prim2Ref> unsortedRefs;
+};
+
+// Order preserving map of a float to an unsigned int
+inline unsigned int World2FloatKey(float f) {
+	union { float f; unsigned int u; } v;
+	v.f = f;
+	return (v.u & 0x80000000) ? ~v.u : v.u | 0x80000000;
+}
+
+// Bitmask of lanes j..j+3 that overlap box i and pass the filter; lanes past the end never pass.
+// *pInX gets the lanes whose minX is within box i's maxX.
+inline int World2SweepLanes(const World2PairScratch &s, size_t i, size_t j, int *pInX) {
+#ifdef SAW_GEOM_SSE2
+	__m128 inX = _mm_cmple_ps(_mm_loadu_ps(&s.minX[j]), _mm_set1_ps(s.maxX[i]));
+	__m128 inY = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&s.minY[j]), _mm_set1_ps(s.maxY[i])),
+		_mm_cmpge_ps(_mm_loadu_ps(&s.maxY[j]), _mm_set1_ps(s.minY[i])));
+	__m128i zero = _mm_setzero_si128();
+	__m128i catJ = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&s.category[j]));
+	__m128i maskJ = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&s.mask[j]));
+	__m128i blocked = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(catJ, _mm_set1_epi32(static_cast<int>(s.mask[i]))), zero),
+		_mm_cmpeq_epi32(_mm_and_si128(maskJ, _mm_set1_epi32(static_cast<int>(s.category[i]))), zero));
+	*pInX = _mm_movemask_ps(inX);
+	return _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), _mm_and_ps(inX, inY)));
+#else
+	int inX = 0, lanes = 0;
+	for (int k = 0; k < 4; k++) {
+		if (s.minX[j + k] > s.maxX[i])
+			continue;
+		inX |= 1 << k;
+		if (s.minY[j + k] <= s.maxY[i] && s.maxY[j + k] >= s.minY[i] &&
+			World2CanPair(s.category[i], s.mask[i], s.category[j + k], s.mask[j + k]))
+			lanes |= 1 << k;
+	}
+	*pInX = inX;
+	return lanes;
+#endif
+}
+
+// Every pair of primitives whose bounds overlap and whose filters allow pairing.
+// Pairs hold World2GetRef references, the one with lower minX first; order is deterministic.
+inline void World2FindPairs(const World2 *w, std::vector<Cd2Pair> *pPairs, World2PairScratch *pScratch) {
+	SAW_PROF_SCOPE("World2FindPairs");
+	pPairs->clear();
+	World2PairScratch &s = *pScratch;
+	s.sortKeys.clear();
+	s.unsortedRefs.clear();
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		const World2Pool &pool = w->pools[t];
+		for (size_t i = 0; i < pool.handles.size(); i++) {
+			s.sortKeys.push_back((static_cast<unsigned long long>(World2FloatKey(pool.bounds[0][i])) << 32) | s.unsortedRefs.size());
+			s.unsortedRefs.push_back(Prim2MakeRef(static_cast<Prim2Type>(t), static_cast<unsigned int>(i)));
+		}
+	}
+	size_t n = s.unsortedRefs.size();
+	std::sort(s.sortKeys.begin(), s.sortKeys.end());
+
+	// Gather into sorted structure-of-arrays
+	s.minX.resize(n + 3);
+	s.minY.resize(n + 3);
+	s.maxX.resize(n + 3);
+	s.maxY.resize(n + 3);
+	s.category.resize(n + 3);
+	s.mask.resize(n + 3);
+	s.refs.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		Prim2Ref ref = s.unsortedRefs[s.sortKeys[i] & 0xffffffff];
+		const World2Pool &pool = w->pools[Prim2RefType(ref)];
+		unsigned int index = Prim2RefIndex(ref);
+		s.minX[i] = pool.bounds[0][index];
+		s.minY[i] = pool.bounds[1][index];
+		s.maxX[i] = pool.bounds[2][index];
+		s.maxY[i] = pool.bounds[3][index];
+		s.category[i] = pool.category[index];
+		s.mask[i] = pool.mask[index];
+		s.refs[i] = ref;
+	}
+	for (size_t i = n; i < n + 3; i++) {
+		s.minX[i] = s.minY[i] = 3.4e38f;
+		s.maxX[i] = s.maxY[i] = -3.4e38f;
+		s.category[i] = s.mask[i] = 0;
+	}
+
+	// Sweep: boxes after i in sorted order overlap on x until the first one starting past maxX
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = i + 1; j < n; j += 4) {
+			int inX = 0;
+			int lanes = World2SweepLanes(s, i, j, &inX);
+			for (int k = 0; lanes; k++, lanes >>= 1)
+				if (lanes & 1)
+					pPairs->push_back(Cd2Pair(s.refs[i], s.refs[j + k]));
+			if (inX != 0xf)
+				break;
+		}
+	}
+}
+
+// Handles of every primitive whose bounds overlap box and whose filter allows pairing with category/mask
+inline void World2QueryAabb(const World2 *w, const Aabb2 &box, unsigned int category, unsigned int mask,
+	std::vector<World2Handle> *pOut) {
+	pOut->clear();
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		const World2Pool &pool = w->pools[t];
+		size_t n = pool.handles.size(), i = 0;
+#ifdef SAW_GEOM_SSE2
+		__m128 bMinX = _mm_set1_ps(box.minX), bMinY = _mm_set1_ps(box.minY);
+		__m128 bMaxX = _mm_set1_ps(box.maxX), bMaxY = _mm_set1_ps(box.maxY);
+		__m128i qCat = _mm_set1_epi32(static_cast<int>(category)), qMask = _mm_set1_epi32(static_cast<int>(mask));
+		__m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= n; i += 4) {
+			__m128 hit = _mm_and_ps(
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&pool.bounds[0][i]), bMaxX), _mm_cmpge_ps(_mm_loadu_ps(&pool.bounds[2][i]), bMinX)),
+				_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&pool.bounds[1][i]), bMaxY), _mm_cmpge_ps(_mm_loadu_ps(&pool.bounds[3][i]), bMinY)));
+			__m128i blocked = _mm_or_si128(
+				_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&pool.category[i])), qMask), zero),
+				_mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&pool.mask[i])), qCat), zero));
+			int lanes = _mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(blocked), hit));
+			for (int k = 0; lanes; k++, lanes >>= 1)
+				if (lanes & 1)
+					pOut->push_back(pool.handles[i + k]);
+		}
+#endif
+		for (; i < n; i++) {
+			if (pool.bounds[0][i] <= box.maxX && pool.bounds[2][i] >= box.minX && pool.bounds[1][i] <= box.maxY &&
+				pool.bounds[3][i] >= box.minY && World2CanPair(category, mask, pool.category[i], pool.mask[i]))
+				pOut->push_back(pool.handles[i]);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// CONTACT CACHE
+//-----------------------------------------------------------------------------------------------------------
+
+struct Contact2Event {
+	World2Handle a, b;  // a < b
+};
+
+struct Contact2Cache {
+	std::vector<unsigned long long> keys;  // Open addressing table of pair keys, 0 if empty
+	std::vector<unsigned int> keyLive;     // Index in live of each table entry
+	std::vector<unsigned long long> live;  // Key of every current contact
+	std::vector<unsigned int> liveSlot;    // Table index of every current contact
+	std::vector<unsigned int> liveFrame;   // Update every current contact was last touched in
+	unsigned int frame;
+	bool reportStay;                       // Fill stays; turn off if only begin/end are wanted
+	std::vector<Contact2Event> begins, stays, ends;
+	Contact2Cache() : frame(0), reportStay(true) { }
+};
+
+inline unsigned long long Contact2Key(World2Handle a, World2Handle b) {
+	return a < b ? (static_cast<unsigned long long>(a) << 32) | b : (static_cast<unsigned long long>(b) << 32) | a;
+}
+
+inline Contact2Event Contact2KeyToEvent(unsigned long long key) {
+	Contact2Event e = { static_cast<World2Handle>(key >> 32), static_cast<World2Handle>(key & 0xffffffff) };
+	return e;
+}
+
+inline size_t Contact2Hash(unsigned long long key, size_t mask) {
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	return static_cast<size_t>(key) & mask;
+}
+
+// Double the table (or create it) and reinsert every current contact
+inline void Contact2CacheGrow(Contact2Cache *pCache) {
+	size_t size = pCache->keys.empty() ? 64 : pCache->keys.size() * 2;
+	pCache->keys.assign(size, 0);
+	pCache->keyLive.resize(size);
+	for (size_t i = 0; i < pCache->live.size(); i++) {
+		size_t at = Contact2Hash(pCache->live[i], size - 1);
+		while (pCache->keys[at])
+			at = (at + 1) & (size - 1);
+		pCache->keys[at] = pCache->live[i];
+		pCache->keyLive[at] = static_cast<unsigned int>(i);
+		pCache->liveSlot[i] = static_cast<unsigned int>(at);
+	}
+}
+
+// Remove table entry at, shifting back later entries of the probe run (no tombstones)
+inline void Contact2CacheErase(Contact2Cache *pCache, size_t at) {
+	size_t mask = pCache->keys.size() - 1;
+	size_t next = (at + 1) & mask;
+	while (pCache->keys[next]) {
+		size_t home = Contact2Hash(pCache->keys[next], mask);
+		// Move next into the hole if its home is not cyclically within (at, next]
+		if (((next - home) & mask) >= ((next - at) & mask)) {
+			pCache->keys[at] = pCache->keys[next];
+			pCache->keyLive[at] = pCache->keyLive[next];
+			pCache->liveSlot[pCache->keyLive[at]] = static_cast<unsigned int>(at);
+			at = next;
+		}
+		next = (next + 1) & mask;
+	}
+	pCache->keys[at] = 0;
+}
+
+inline void Contact2CacheClear(Contact2Cache *pCache) {
+	pCache->keys.assign(pCache->keys.size(), 0);
+	pCache->live.clear();
+	pCache->liveSlot.clear();
+	pCache->liveFrame.clear();
+	pCache->begins.clear();
+	pCache->stays.clear();
+	pCache->ends.clear();
+}
+
+// Start an update; clears the event lists
+inline void Contact2CacheBegin(Contact2Cache *pCache) {
+	pCache->frame++;
+	pCache->begins.clear();
+	pCache->stays.clear();
+	pCache->ends.clear();
+}
+
+// Report a colliding pair; reporting a pair more than once per update is harmless
+inline void Contact2CacheTouch(Contact2Cache *pCache, World2Handle a, World2Handle b) {
+	if ((pCache->live.size() + 1) * 2 > pCache->keys.size())
+		Contact2CacheGrow(pCache);
+	unsigned long long key = Contact2Key(a, b);
+	size_t mask = pCache->keys.size() - 1;
+	size_t at = Contact2Hash(key, mask);
+	while (pCache->keys[at]) {
+		if (pCache->keys[at] == key) {
+			unsigned int i = pCache->keyLive[at];
+			if (pCache->liveFrame[i] != pCache->frame) {
+				pCache->liveFrame[i] = pCache->frame;
+				if (pCache->reportStay)
+					pCache->stays.push_back(Contact2KeyToEvent(key));
+			}
+			return;
+		}
+		at = (at + 1) & mask;
+	}
+	pCache->keys[at] = key;
+	pCache->keyLive[at] = static_cast<unsigned int>(pCache->live.size());
+	pCache->live.push_back(key);
+	pCache->liveSlot.push_back(static_cast<unsigned int>(at));
+	pCache->liveFrame.push_back(pCache->frame);
+	pCache->begins.push_back(Contact2KeyToEvent(key));
+}
+
+// Finish an update; every contact not touched since Contact2CacheBegin ends
+inline void Contact2CacheEnd(Contact2Cache *pCache) {
+	size_t i = 0;
+	while (i < pCache->live.size()) {
+		if (pCache->liveFrame[i] == pCache->frame) {
+			i++;
+			continue;
+		}
+		pCache->ends.push_back(Contact2KeyToEvent(pCache->live[i]));
+		Contact2CacheErase(pCache, pCache->liveSlot[i]);
+		size_t last = pCache->live.size() - 1;
+		if (i != last) {
+			pCache->live[i] = pCache->live[last];
+			pCache->liveSlot[i] = pCache->liveSlot[last];
+			pCache->liveFrame[i] = pCache->liveFrame[last];
+			pCache->keyLive[pCache->liveSlot[i]] = static_cast<unsigned int>(i);
+		}
+		pCache->live.pop_back();
+		pCache->liveSlot.pop_back();
+		pCache->liveFrame.pop_back();
+	}
+}
+
+// Whole update from narrowphase output over World2GetRef references
+inline void Contact2CacheUpdate(Contact2Cache *pCache, const World2 *w, const Cd2Pair *pairs,
+	const unsigned int *hits, size_t numHits) {
+	SAW_PROF_SCOPE("Contact2CacheUpdate");
+	Contact2CacheBegin(pCache);
+	for (size_t i = 0; i < numHits; i++) {
+		const Cd2Pair &pair = pairs[hits[i]];
+		Contact2CacheTouch(pCache, World2RefToHandle(w, pair.a), World2RefToHandle(w, pair.b));
+	}
+	Contact2CacheEnd(pCache);
+}
+
+inline size_t Contact2CacheGetCount(const Contact2Cache *pCache) {
+	return pCache->live.size();
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// SNAPSHOTS
+//-----------------------------------------------------------------------------------------------------------
+
+// Immutable copy of the world's bounds and filters at one epoch
+struct World2Snapshot {
+	mutable std::atomic<int> readers;
+	unsigned long long epoch;
+	std::vector<Aabb2> bounds;           // One entry per primitive, all types
+	std::vector<World2Handle> handles;
+	std::vector<unsigned int> category;
+	std::vector<unsigned int> mask;
+	std::vector<unsigned int> slotEntry; // Entry of each world slot, for lookup by handle
+	Bvh2<4> bvh;
+	World2Snapshot() : readers(0), epoch(0) { }
+};
+
+struct World2Snapshots {
+	std::atomic<World2Snapshot *> current;  // Shared with readers
+	std::vector<World2Snapshot *> buffers;  // Writer only
+	unsigned long long epoch;
+	int numSpare;                           // Unpinned buffers kept besides the current one
+	Bvh2BuildScratch scratch;
+	World2Snapshots() : current(0), epoch(0), numSpare(2) { }
+	~World2Snapshots() {
+		for (size_t i = 0; i < buffers.size(); i++)
+			delete buffers[i];
+	}
+private:
+	World2Snapshots(const World2Snapshots &);
+	World2Snapshots &operator=(const World2Snapshots &);
+};
+
+// Writer: publish the world as a new epoch. Never waits on readers. pool may be null.
+inline void World2Publish(World2Snapshots *pSnaps, const World2 *w, saw::JobPool *pool) {
+	SAW_PROF_SCOPE("World2Publish");
+	World2Snapshot *cur = pSnaps->current.load();
+	World2Snapshot *snap = 0;
+	for (size_t i = 0; i < pSnaps->buffers.size() && !snap; i++)
+		if (pSnaps->buffers[i] != cur && pSnaps->buffers[i]->readers.load() == 0)
+			snap = pSnaps->buffers[i];
+	if (!snap) {
+		snap = new World2Snapshot;
+		pSnaps->buffers.push_back(snap);
+	}
+
+	// A stale reader may bump readers while this is written, but it rechecks current and backs off
+	snap->epoch = ++pSnaps->epoch;
+	snap->bounds.clear();
+	snap->handles.clear();
+	snap->category.clear();
+	snap->mask.clear();
+	snap->slotEntry.assign(w->slots.size(), 0);
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		const World2Pool &p = w->pools[t];
+		for (size_t i = 0; i < p.handles.size(); i++) {
+			snap->slotEntry[World2HandleSlot(p.handles[i])] = static_cast<unsigned int>(snap->handles.size());
+			snap->bounds.push_back(Aabb2(p.bounds[0][i], p.bounds[1][i], p.bounds[2][i], p.bounds[3][i]));
+			snap->handles.push_back(p.handles[i]);
+			snap->category.push_back(p.category[i]);
+			snap->mask.push_back(p.mask[i]);
+		}
+	}
+	Bvh2Build(pool, snap->bounds.empty() ? 0 : &snap->bounds[0], snap->bounds.size(), &snap->bvh, &pSnaps->scratch);
+	pSnaps->current.store(snap);
+
+	// Release memory of unpinned buffers beyond the spares
+	int spare = 0;
+	for (size_t i = 0; i < pSnaps->buffers.size(); i++) {
+		World2Snapshot *b = pSnaps->buffers[i];
+		if (b == snap || b->readers.load() != 0 || spare++ < pSnaps->numSpare)
+			continue;
+		std::vector<Aabb2>().swap(b->bounds);
+		std::vector<World2Handle>().swap(b->handles);
+		std::vector<unsigned int>().swap(b->category);
+		std::vector<unsigned int>().swap(b->mask);
+		std::vector<unsigned int>().swap(b->slotEntry);
+		std::vector<Bvh2Node<4> >().swap(b->bvh.nodes);
+		std::vector<unsigned int>().swap(b->bvh.indices);
+	}
+}
+
+// Reader: pin the current epoch so the writer will not reuse it. Returns null if nothing is published yet.
+// Every pin must be matched by World2SnapshotUnpin.
+inline const World2Snapshot *World2SnapshotPin(World2Snapshots *pSnaps) {
+	for (;;) {
+		World2Snapshot *snap = pSnaps->current.load();
+		if (!snap)
+			return 0;
+		snap->readers.fetch_add(1);
+		if (pSnaps->current.load() == snap)
+			return snap;
+		snap->readers.fetch_sub(1);  // Superseded in between; it may already be rewritten
+	}
+}
+
+inline void World2SnapshotUnpin(const World2Snapshot *snap) {
+	if (snap)
+		snap->readers.fetch_sub(1);
+}
+
+inline unsigned long long World2SnapshotGetEpoch(const World2Snapshot *snap) {
+	return snap->epoch;
+}
+
+inline bool World2SnapshotGetBounds(const World2Snapshot *snap, World2Handle h, Aabb2 *pOut) {
+	unsigned int slot = World2HandleSlot(h);
+	if (h == WORLD2_NULL || slot >= snap->slotEntry.size())
+		return false;
+	unsigned int entry = snap->slotEntry[slot];
+	if (entry >= snap->handles.size() || snap->handles[entry] != h)
+		return false;
+	*pOut = snap->bounds[entry];
+	return true;
+}
+
+// Handles of every primitive whose bounds overlap box and whose filter allows pairing with category/mask.
+// pScratch holds intermediate indices and may be reused between calls.
+inline void World2SnapshotQueryAabb(const World2Snapshot *snap, const Aabb2 &box, unsigned int category,
+	unsigned int mask, std::vector<World2Handle> *pOut, std::vector<unsigned int> *pScratch) {
+	pOut->clear();
+	Bvh2QueryAabb(snap->bvh, snap->bounds.empty() ? 0 : &snap->bounds[0], box, pScratch);
+	for (size_t i = 0; i < pScratch->size(); i++) {
+		unsigned int e = (*pScratch)[i];
+		if (World2CanPair(category, mask, snap->category[e], snap->mask[e]))
+			pOut->push_back(snap->handles[e]);
+	}
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// VIEW QUERIES
+//-----------------------------------------------------------------------------------------------------------
+
+// Handles overlapping a rectangle that moves from update to update (a camera, a player's area of interest).
+// Only primitives entering or leaving the view are reported. Follows one World2Snapshots.
+struct World2View {
+	std::vector<World2Handle> handles;    // Inside the view, in no particular order
+	std::vector<World2Handle> entered;    // Since the previous update
+	std::vector<World2Handle> exited;
+	std::vector<unsigned int> slotEntry;  // Index in handles of each world slot, valid if handles[i] matches
+	std::vector<unsigned int> seen;       // Update a member was last found in, for full updates
+	std::vector<unsigned int> found;      // Scratch snapshot entries
+	Aabb2 box;
+	unsigned int category, mask;
+	unsigned long long epoch;             // Of the snapshot the view was last updated on, 0 for none
+	unsigned int frame;
+	World2View() : box(0, 0, 0, 0), category(0), mask(0), epoch(0), frame(0) { }
+};
+
+// Up to 4 boxes that together cover every point of a outside b. They may overlap b's boundary.
+inline int World2BoxDiff(const Aabb2 &a, const Aabb2 &b, Aabb2 *pOut) {
+	if (!Cd2AA(a, b)) {
+		pOut[0] = a;
+		return 1;
+	}
+	int num = 0;
+	if (a.minX < b.minX)
+		pOut[num++] = Aabb2(a.minX, a.minY, b.minX, a.maxY);
+	if (a.maxX > b.maxX)
+		pOut[num++] = Aabb2(b.maxX, a.minY, a.maxX, a.maxY);
+	float minX = a.minX > b.minX ? a.minX : b.minX, maxX = a.maxX < b.maxX ? a.maxX : b.maxX;
+	if (a.minY < b.minY)
+		pOut[num++] = Aabb2(minX, a.minY, maxX, b.minY);
+	if (a.maxY > b.maxY)
+		pOut[num++] = Aabb2(minX, b.maxY, maxX, a.maxY);
+	return num;
+}
+
+inline bool World2ViewHas(const World2View *pView, World2Handle h) {
+	unsigned int slot = World2HandleSlot(h);
+	if (slot >= pView->slotEntry.size())
+		return false;
+	unsigned int entry = pView->slotEntry[slot];
+	return entry < pView->handles.size() && pView->handles[entry] == h;
+}
+
+inline void World2ViewAdd(World2View *pView, World2Handle h) {
+	unsigned int slot = World2HandleSlot(h);
+	if (slot >= pView->slotEntry.size())
+		pView->slotEntry.resize(slot + 1, 0);
+	pView->slotEntry[slot] = static_cast<unsigned int>(pView->handles.size());
+	pView->handles.push_back(h);
+	pView->seen.push_back(pView->frame);
+	pView->entered.push_back(h);
+}
+
+// Swap-remove member entry
+inline void World2ViewErase(World2View *pView, unsigned int entry) {
+	pView->exited.push_back(pView->handles[entry]);
+	unsigned int last = static_cast<unsigned int>(pView->handles.size() - 1);
+	if (entry != last) {
+		pView->handles[entry] = pView->handles[last];
+		pView->seen[entry] = pView->seen[last];
+		pView->slotEntry[World2HandleSlot(pView->handles[entry])] = entry;
+	}
+	pView->handles.pop_back();
+	pView->seen.pop_back();
+}
+
+// Forget every member without reporting them as exited
+inline void World2ViewClear(World2View *pView) {
+	pView->handles.clear();
+	pView->seen.clear();
+	pView->entered.clear();
+	pView->exited.clear();
+	pView->epoch = 0;
+}
+
+// Move the view to box and fill entered/exited with the handles whose bounds started or stopped
+// overlapping it (among those whose filter allows pairing with category/mask).
+// On the epoch of the previous update, only the strips of box outside the previous box (and the reverse)
+// are queried, so a view that moves a little costs little however many handles it holds.
+// On a new epoch (primitives may have moved) or filter, the whole box is queried and compared to the members.
+inline void World2ViewUpdate(World2View *pView, const World2Snapshot *snap, const Aabb2 &box, unsigned int category,
+	unsigned int mask) {
+	SAW_PROF_SCOPE("World2ViewUpdate");
+	World2View &v = *pView;
+	v.entered.clear();
+	v.exited.clear();
+	v.frame++;
+	const Aabb2 *bounds = snap->bounds.empty() ? 0 : &snap->bounds[0];
+	if (v.epoch != snap->epoch || v.category != category || v.mask != mask) {
+		Bvh2QueryAabb(snap->bvh, bounds, box, &v.found);
+		for (size_t i = 0; i < v.found.size(); i++) {
+			unsigned int e = v.found[i];
+			if (!World2CanPair(category, mask, snap->category[e], snap->mask[e]))
+				continue;
+			World2Handle h = snap->handles[e];
+			if (World2ViewHas(pView, h))
+				v.seen[v.slotEntry[World2HandleSlot(h)]] = v.frame;
+			else
+				World2ViewAdd(pView, h);
+		}
+		for (size_t i = v.handles.size(); i-- > 0;)
+			if (v.seen[i] != v.frame)
+				World2ViewErase(pView, static_cast<unsigned int>(i));
+	} else {
+		Aabb2 strips[4];
+		int num = World2BoxDiff(v.box, box, strips);
+		for (int r = 0; r < num; r++) {
+			Bvh2QueryAabb(snap->bvh, bounds, strips[r], &v.found);
+			for (size_t i = 0; i < v.found.size(); i++) {
+				unsigned int e = v.found[i];
+				World2Handle h = snap->handles[e];
+				if (!Cd2AA(bounds[e], box) && World2ViewHas(pView, h))
+					World2ViewErase(pView, v.slotEntry[World2HandleSlot(h)]);
+			}
+		}
+		num = World2BoxDiff(box, v.box, strips);
+		for (int r = 0; r < num; r++) {
+			Bvh2QueryAabb(snap->bvh, bounds, strips[r], &v.found);
+			for (size_t i = 0; i < v.found.size(); i++) {
+				unsigned int e = v.found[i];
+				World2Handle h = snap->handles[e];
+				if (!Cd2AA(bounds[e], v.box) && World2CanPair(category, mask, snap->category[e], snap->mask[e]) &&
+					!World2ViewHas(pView, h))
+					World2ViewAdd(pView, h);
+			}
+		}
+	}
+	v.box = box;
+	v.category = category;
+	v.mask = mask;
+	v.epoch = snap->epoch;
+}
+
+//-----------------------------------------------------------------------------------------------------------
+// ROLLBACK
+//-----------------------------------------------------------------------------------------------------------
+
+static const size_t WORLD2_PAGE_SIZE = 4096;
+
+// Call v(array) for every array of rollback state and v.Value(field) for every other field, always in the
+// same order. W, C and B may be const. pCache and pBvh may be null.
+template <class V, class W, class C, class B> inline void World2RollbackVisit(V &v, W *w, C *pCache, B *pBvh) {
+	for (int t = 0; t < PRIM2_COUNT; t++) {
+		for (int i = 0; i < w->pools[t].numComps; i++)
+			v(w->pools[t].comps[i]);
+		for (int i = 0; i < 4; i++)
+			v(w->pools[t].bounds[i]);
+		v(w->pools[t].category);
+		v(w->pools[t].mask);
+		v(w->pools[t].handles);
+	}
+	v(w->slots);
+	v.Value(w->freeHead);
+	if (pCache) {
+		v(pCache->keys);
+		v(pCache->keyLive);
+		v(pCache->live);
+		v(pCache->liveSlot);
+		v(pCache->liveFrame);
+		v(pCache->begins);
+		v(pCache->stays);
+		v(pCache->ends);
+		v.Value(pCache->frame);
+	}
+	if (pBvh) {
+		v(pBvh->nodes);
+		v(pBvh->indices);
+		v.Value(pBvh->bounds);
+	}
+}
+
+// Where one array lives in the image: a page aligned region with room to grow
+struct World2RollbackRegion {
+	size_t offset, capacity;  // Bytes, both multiples of WORLD2_PAGE_SIZE
+	size_t count;             // Elements
+};
+
+// One saved frame: its layout and fields, and the pages its save overwrote (as they were the frame before)
+struct World2RollbackFrame {
+	unsigned int frame;
+	std::vector<World2RollbackRegion> layout;
+	std::vector<unsigned char> values;  // Fields other than arrays, packed
+	std::vector<unsigned int> pages;    // Overwritten page indices
+	std::vector<unsigned char> undo;    // Their previous contents, WORLD2_PAGE_SIZE each
+	size_t prevSize;                    // Image size the frame before
+};
+
+struct World2Rollback {
+	int numFrames;                            // Frames kept for restore (at least 1)
+	std::vector<unsigned char> image;         // Every array of the newest frame, each in its own region
+	std::vector<World2RollbackFrame> frames;  // Ring, oldest at first
+	size_t first, count;
+	size_t lastPages;                         // Pages copied by the last save, for profiling
+	World2Rollback() : numFrames(9), first(0), count(0), lastPages(0) { }
+};
+
+inline void World2RollbackClear(World2Rollback *pRb) {
+	pRb->first = pRb->count = 0;
+}
+
+// Compare each array with its region and copy only the pages that differ, keeping their old contents.
+// An array outgrowing its region moves to a new one at the end of the image, 1.5 times its size.
+struct World2RollbackSaver {
+	World2Rollback *pRb;
+	World2RollbackFrame *pFrame;
+	size_t index, pages;
+	template <class T> void operator()(const std::vector<T> &a) {
+		std::vector<unsigned char> &image = pRb->image;
+		World2RollbackRegion &region = pFrame->layout[index++];
+		size_t bytes = a.size() * sizeof(T);
+		if (bytes > region.capacity) {
+			region.offset = image.size();
+			region.capacity = (bytes + bytes / 2 + WORLD2_PAGE_SIZE - 1) / WORLD2_PAGE_SIZE * WORLD2_PAGE_SIZE;
+			image.resize(region.offset + region.capacity);
+		}
+		region.count = a.size();
+		const unsigned char *src = reinterpret_cast<const unsigned char *>(a.empty() ? 0 : &a[0]);
+		for (size_t at = 0; at < bytes; at += WORLD2_PAGE_SIZE) {
+			size_t len = bytes - at < WORLD2_PAGE_SIZE ? bytes - at : WORLD2_PAGE_SIZE;
+			unsigned char *dst = &image[region.offset + at];
+			if (memcmp(dst, src + at, len) == 0)
+				continue;
+			if (region.offset + at < pFrame->prevSize) {
+				pFrame->pages.push_back(static_cast<unsigned int>((region.offset + at) / WORLD2_PAGE_SIZE));
+				pFrame->undo.insert(pFrame->undo.end(), dst, dst + WORLD2_PAGE_SIZE);
+			}
+			memcpy(dst, src + at, len);
+			pages++;
+		}
+	}
+	template <class T> void Value(const T &value) {
+		const unsigned char *p = reinterpret_cast<const unsigned char *>(&value);
+		pFrame->values.insert(pFrame->values.end(), p, p + sizeof(T));
+	}
+};
+
+struct World2RollbackLoader {
+	const World2Rollback *pRb;
+	const World2RollbackFrame *pFrame;
+	size_t index, at;
+	template <class T> void operator()(std::vector<T> &a) {
+		const World2RollbackRegion &region = pFrame->layout[index++];
+		a.resize(region.count);
+		if (region.count)
+			memcpy(&a[0], &pRb->image[region.offset], region.count * sizeof(T));
+	}
+	template <class T> void Value(T &value) {
+		memcpy(&value, &pFrame->values[at], sizeof(T));
+		at += sizeof(T);
+	}
+};
+
+struct World2RollbackCounter {
+	size_t arrays;
+	template <class T> void operator()(const std::vector<T> &) { arrays++; }
+	template <class T> void Value(const T &) { }
+};
+
+// Save the state as frame, which must be past every frame kept. The contact cache and hierarchy may be
+// null, but Restore must then get them null too. Past numFrames the oldest frame is forgotten.
+inline void World2RollbackSave(World2Rollback *pRb, unsigned int frame, const World2 *w, const Contact2Cache *pCache,
+	const Bvh2<4> *pBvh) {
+	SAW_PROF_SCOPE("World2RollbackSave");
+	World2Rollback &rb = *pRb;
+	size_t ring = rb.numFrames > 1 ? static_cast<size_t>(rb.numFrames) : 1;
+	if (rb.frames.size() != ring) {
+		rb.frames.resize(ring);
+		rb.first = rb.count = 0;
+	}
+	if (rb.count == ring) {
+		rb.first = (rb.first + 1) % ring;
+		rb.count--;
+	}
+	World2RollbackFrame &f = rb.frames[(rb.first + rb.count) % ring];
+	if (rb.count)
+		f.layout = rb.frames[(rb.first + rb.count - 1) % ring].layout;
+	else {
+		// Nothing to undo to: lay the image out afresh
+		World2RollbackCounter counter = { 0 };
+		World2RollbackVisit(counter, w, pCache, pBvh);
+		World2RollbackRegion empty = { 0, 0, 0 };
+		f.layout.assign(counter.arrays, empty);
+		rb.image.clear();
+	}
+	f.frame = frame;
+	f.values.clear();
+	f.pages.clear();
+	f.undo.clear();
+	f.prevSize = rb.image.size();
+	World2RollbackSaver saver = { pRb, &f, 0, 0 };
+	World2RollbackVisit(saver, w, pCache, pBvh);
+	rb.count++;
+	rb.lastPages = saver.pages;
+}
+
+inline bool World2RollbackHas(const World2Rollback *pRb, unsigned int frame) {
+	for (size_t i = 0; i < pRb->count; i++)
+		if (pRb->frames[(pRb->first + i) % pRb->frames.size()].frame == frame)
+			return true;
+	return false;
+}
+
+// Restore the state saved as frame, and forget the frames after it. The pages saved since then are put back
+// from their old contents, then every array is copied out of the image; nothing is rebuilt.
+// Fails if frame is not kept.
+inline bool World2RollbackRestore(World2Rollback *pRb, unsigned int frame, World2 *w, Contact2Cache *pCache,
+	Bvh2<4> *pBvh) {
+	SAW_PROF_SCOPE("World2RollbackRestore");
+	World2Rollback &rb = *pRb;
+	if (!World2RollbackHas(pRb, frame))
+		return false;
+	size_t ring = rb.frames.size();
+	while (rb.frames[(rb.first + rb.count - 1) % ring].frame != frame) {
+		const World2RollbackFrame &undo = rb.frames[(rb.first + rb.count - 1) % ring];
+		for (size_t i = 0; i < undo.pages.size(); i++)
+			memcpy(&rb.image[undo.pages[i] * WORLD2_PAGE_SIZE], &undo.undo[i * WORLD2_PAGE_SIZE], WORLD2_PAGE_SIZE);
+		rb.image.resize(undo.prevSize);  // Drops regions added by that save
+		rb.count--;
+	}
+	World2RollbackLoader loader = { pRb, &rb.frames[(rb.first + rb.count - 1) % ring], 0, 0 };
+	World2RollbackVisit(loader, w, pCache, pBvh);
+	return true;
+}
+
+}  // namespace
+
+#endif  // _SAW_GEOM_WORLD2_INCLUDED
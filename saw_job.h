@@ -0,0 +1,251 @@
+// saw_job.h - Thread pool with work stealing parallel for
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.02 - 10/19/26 - JobPoolFor waits for every worker to leave the call, so no late thief sees the next one
+// - v1.01 - 10/19/26 - Implementation may be included more than once (through other headers)
+// - v1.00 - 10/19/26 - Initial release
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - Fixed set of worker threads; the thread calling JobPoolFor takes part as worker 0
+// - JobPoolFor runs tasks 0..numTasks-1. Each worker starts on its own contiguous block of tasks and,
+//   once that runs out, steals the back half of another worker's block.
+// - The worker index passed to a task is in 0..JobPoolGetWorkers()-1 and is never shared by two tasks
+//   running at the same time, so tasks can write to per-worker buffers without locking
+// - JobPoolFor returns once every task has finished and every worker has stopped looking for more, so the
+//   next call can refill the blocks without a thief from this one still moving them
+// - Not reentrant: tasks must not call JobPoolFor on the pool running them
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Define SAW_JOB_IMPLEMENTATION before inclusion in one file for library implementation
+// - Functionality is in saw:: namespace
+
+#ifndef _SAW_JOB_H_INCLUDED
+#define _SAW_JOB_H_INCLUDED
+
+#include <stddef.h>
+
+namespace saw {
+
+typedef void(*JobFunc)(size_t task, int worker, void *user);
+
+struct JobPool {
+	void *impl;
+	int numWorkers;
+};
+
+bool JobPoolInit(JobPool *pool, int numWorkers);  // numWorkers includes the calling thread; 0 for one per hardware thread
+void JobPoolFree(JobPool *pool);
+void JobPoolFor(JobPool *pool, size_t numTasks, JobFunc func, void *user);  // pool may be null to run on the calling thread
+inline int JobPoolGetWorkers(const JobPool *pool);  // 1 if pool is null
+
+//-----------------------------------------------------------------------------------------------------------
+inline int JobPoolGetWorkers(const JobPool *pool) {
+	return pool && pool->impl ? pool->numWorkers : 1;
+}
+
+}  // namespace
+
+#endif  // _SAW_JOB_H_INCLUDED
+
+
+#if defined(SAW_JOB_IMPLEMENTATION) && !defined(_SAW_JOB_IMPLEMENTED)
+#define _SAW_JOB_IMPLEMENTED
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace saw {
+
+	struct JobQueue {
+		std::mutex lock;
+		size_t lo, hi;  // Tasks not yet taken: lo..hi-1
+		char pad[64];   // Keep queues of different workers off each other's cache lines
+	};
+
+	struct JobPoolImpl {
+		std::vector<std::thread> threads;
+		JobQueue *queues;
+		std::mutex wakeLock;
+		std::condition_variable wake;
+		std::condition_variable done;
+		unsigned long long generation;  // Bumped for every JobPoolFor
+		int finished;                   // Workers (besides the caller) done with the current generation
+		bool quit;
+		JobFunc func;
+		void *user;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------
+	static bool JobPop(JobPoolImpl *impl, int numWorkers, int worker, size_t *pTask) {
+		JobQueue &own = impl->queues[worker];
+		{
+			std::lock_guard<std::mutex> guard(own.lock);
+			if (own.lo < own.hi) {
+				*pTask = own.lo++;
+				return true;
+			}
+		}
+		// Own block is empty, steal the back half of someone else's
+		for (int i = 1; i < numWorkers; i++) {
+			JobQueue &victim = impl->queues[(worker + i) % numWorkers];
+			size_t lo, hi;
+			{
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if (victim.lo >= victim.hi)
+					continue;
+				lo = victim.lo + (victim.hi - victim.lo) / 2;
+				hi = victim.hi;
+				victim.hi = lo;
+			}
+			std::lock_guard<std::mutex> guard(own.lock);
+			own.lo = lo + 1;
+			own.hi = hi;
+			*pTask = lo;
+			return true;
+		}
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	static void JobRun(JobPoolImpl *impl, int numWorkers, int worker) {
+		size_t task = 0;
+		while (JobPop(impl, numWorkers, worker, &task))
+			impl->func(task, worker, impl->user);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	static void JobThread(JobPoolImpl *impl, int numWorkers, int worker) {
+		unsigned long long seen = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> guard(impl->wakeLock);
+				while (!impl->quit && impl->generation == seen)
+					impl->wake.wait(guard);
+				if (impl->quit)
+					return;
+				seen = impl->generation;
+			}
+			JobRun(impl, numWorkers, worker);
+			{
+				std::lock_guard<std::mutex> guard(impl->wakeLock);
+				if (++impl->finished == numWorkers - 1)
+					impl->done.notify_all();
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	bool JobPoolInit(JobPool *pool, int numWorkers) {
+		if (!pool)
+			return false;
+		pool->impl = 0;
+		pool->numWorkers = 1;
+		if (numWorkers <= 0)
+			numWorkers = static_cast<int>(std::thread::hardware_concurrency());
+		if (numWorkers <= 0)
+			numWorkers = 1;
+
+		JobPoolImpl *impl = new JobPoolImpl;
+		impl->queues = new JobQueue[numWorkers];
+		for (int i = 0; i < numWorkers; i++)
+			impl->queues[i].lo = impl->queues[i].hi = 0;
+		impl->generation = 0;
+		impl->finished = 0;
+		impl->quit = false;
+		impl->func = 0;
+		impl->user = 0;
+		pool->impl = impl;
+		pool->numWorkers = numWorkers;
+		try {
+			for (int i = 1; i < numWorkers; i++)
+				impl->threads.push_back(std::thread(JobThread, impl, numWorkers, i));
+		}
+		catch (...) {
+			JobPoolFree(pool);
+			return false;
+		}
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	void JobPoolFree(JobPool *pool) {
+		if (!pool || !pool->impl)
+			return;
+		JobPoolImpl *impl = static_cast<JobPoolImpl *>(pool->impl);
+		{
+			std::lock_guard<std::mutex> guard(impl->wakeLock);
+			impl->quit = true;
+		}
+		impl->wake.notify_all();
+		for (size_t i = 0; i < impl->threads.size(); i++)
+			impl->threads[i].join();
+		delete[] impl->queues;
+		delete impl;
+		pool->impl = 0;
+		pool->numWorkers = 1;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	void JobPoolFor(JobPool *pool, size_t numTasks, JobFunc func, void *user) {
+		if (numTasks == 0)
+			return;
+		if (!pool || !pool->impl || pool->numWorkers <= 1 || numTasks == 1) {
+			for (size_t i = 0; i < numTasks; i++)
+				func(i, 0, user);
+			return;
+		}
+
+		JobPoolImpl *impl = static_cast<JobPoolImpl *>(pool->impl);
+		int numWorkers = pool->numWorkers;
+		// func and user are published to workers through the queue locks
+		impl->func = func;
+		impl->user = user;
+		for (int i = 0; i < numWorkers; i++) {
+			std::lock_guard<std::mutex> guard(impl->queues[i].lock);
+			impl->queues[i].lo = numTasks * i / numWorkers;
+			impl->queues[i].hi = numTasks * (i + 1) / numWorkers;
+		}
+		{
+			std::lock_guard<std::mutex> guard(impl->wakeLock);
+			impl->generation++;
+			impl->finished = 0;
+		}
+		impl->wake.notify_all();
+
+		JobRun(impl, numWorkers, 0);
+		// Every task is done once all workers have left JobRun; waiting for that (not just for the last task)
+		// also keeps a worker still stealing in this call from touching the blocks of the next one
+		std::unique_lock<std::mutex> guard(impl->wakeLock);
+		while (impl->finished != numWorkers - 1)
+			impl->done.wait(guard);
+	}
+
+}  // namespace
+
+#endif  // SAW_JOB_IMPLEMENTATION
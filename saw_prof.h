@@ -0,0 +1,316 @@
+// saw_prof.h - Scoped timing probes in per-thread ring buffers
+//            - Chrome trace (about://tracing, Perfetto) export through saw_io.h
+//
+// This is free and unencumbered software released into the public domain.
+// 
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+//
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+//
+// For more information, please refer to <http://unlicense.org/>
+
+//-----------------------------------------------------------------------------------------------------------
+// History
+// - v1.02 - 10/19/26 - A probe marks its slot as being written before writing it, and ProfCollect drops that
+//                      slot too, so a span it returns is never torn between two events
+// - v1.01 - 10/19/26 - Event fields are relaxed atomics, so ProfCollect reads them without a data race
+//                    - Tick calibration no longer sleeps under the registry lock
+// - v1.00 - 10/19/26 - Initial release
+
+//-----------------------------------------------------------------------------------------------------------
+// Notes
+// - SAW_PROF_SCOPE("name") times the rest of the enclosing block. Probes are compiled in only where
+//   SAW_PROF is defined before inclusion; otherwise the macro expands to nothing.
+// - Only the name pointer is stored, so names must outlive the profile (string literals)
+// - A probe reads the tick counter twice (rdtsc on x86, std::chrono::steady_clock elsewhere or with
+//   SAW_PROF_NO_RDTSC) and writes one event to its thread's ring buffer: no locks and, after a
+//   thread's first probe, no allocation
+// - Each thread keeps its last SAW_PROF_CAPACITY events (a power of 2, default 16384); older ones are
+//   overwritten. Buffers are kept after their thread exits, so its events can still be collected.
+// - ProfCollect copies every thread's events, oldest first, with start and duration in microseconds
+//   since the first probe. It can run while probes record; events overwritten during the copy are dropped.
+//   Event fields are relaxed atomics (plain stores on x86), so reading them meanwhile is not a data race.
+//   Like a seqlock, a probe bumps begun before it writes its slot and head after; ProfCollect checks begun
+//   after copying and drops every event whose slot a probe may have started to overwrite.
+// - The first ProfCollect after the first probe may wait up to 10 ms to calibrate rdtsc, without
+//   holding the lock that a thread's first probe takes
+// - ProfWriteChromeTrace writes the same events as a Chrome trace ("X" events, one track per thread)
+// - ProfClear drops the recorded events; call it while no probes are running
+
+//-----------------------------------------------------------------------------------------------------------
+// Usage
+// - Define SAW_PROF_IMPLEMENTATION before inclusion in one file for library implementation
+// - ProfWriteChromeTrace requires saw_io.h, included by the implementation
+// - Functionality is in saw:: namespace
+
+#ifndef _SAW_PROF_H_INCLUDED
+#define _SAW_PROF_H_INCLUDED
+
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#if !defined(SAW_PROF_NO_RDTSC) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#	define SAW_PROF_RDTSC
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#endif
+
+#ifndef SAW_PROF_CAPACITY
+#	define SAW_PROF_CAPACITY 16384
+#endif
+
+#ifdef SAW_PROF
+#	define SAW_PROF_JOIN2(a, b) a##b
+#	define SAW_PROF_JOIN(a, b) SAW_PROF_JOIN2(a, b)
+#	define SAW_PROF_SCOPE(name) saw::ProfScope SAW_PROF_JOIN(sawProfScope, __LINE__)(name)
+#else
+#	define SAW_PROF_SCOPE(name)
+#endif
+
+namespace saw {
+
+struct Io;
+
+// One timed scope, in ticks while recorded. Written by its thread while ProfCollect may read it.
+struct ProfEvent {
+	std::atomic<const char *> name;
+	std::atomic<unsigned long long> start, end;
+};
+
+// Events as collected, in microseconds since the first probe
+struct ProfSpan {
+	const char *name;
+	double start, duration;
+	int thread;  // Threads are numbered from 0 in order of their first probe
+};
+
+// Ring buffer of one thread. Only its thread writes events; begun counts the events it started to write,
+// head the ones it finished.
+struct ProfThread {
+	std::atomic<unsigned long long> begun, head;
+	ProfEvent events[SAW_PROF_CAPACITY];
+	int id;
+};
+
+ProfThread *ProfAddThread();  // Buffer for the calling thread, on its first probe
+void ProfCollect(std::vector<ProfSpan> *pOut);
+bool ProfWriteChromeTrace(const Io *io);
+void ProfClear();
+inline unsigned long long ProfGetTicks();
+
+//-----------------------------------------------------------------------------------------------------------
+inline unsigned long long ProfGetTicks() {
+#ifdef SAW_PROF_RDTSC
+	return __rdtsc();
+#else
+	return static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline ProfThread *&ProfGetThreadRef() {
+	static thread_local ProfThread *pThread = 0;
+	return pThread;
+}
+
+inline void ProfRecord(const char *name, unsigned long long start, unsigned long long end) {
+	ProfThread *t = ProfGetThreadRef();
+	if (!t)
+		t = ProfAddThread();
+	unsigned long long head = t->head.load(std::memory_order_relaxed);
+	t->begun.store(head + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);  // Orders begun before the event stores
+	ProfEvent &e = t->events[head & (SAW_PROF_CAPACITY - 1)];
+	e.name.store(name, std::memory_order_relaxed);
+	e.start.store(start, std::memory_order_relaxed);
+	e.end.store(end, std::memory_order_relaxed);
+	t->head.store(head + 1, std::memory_order_release);
+}
+
+// Records from construction to destruction (SAW_PROF_SCOPE)
+struct ProfScope {
+	const char *name;
+	unsigned long long start;
+	explicit ProfScope(const char *name) : name(name), start(ProfGetTicks()) { }
+	~ProfScope() { ProfRecord(name, start, ProfGetTicks()); }
+};
+
+}  // namespace
+
+#endif  // _SAW_PROF_H_INCLUDED
+
+
+#if defined(SAW_PROF_IMPLEMENTATION) && !defined(_SAW_PROF_IMPLEMENTED)
+#define _SAW_PROF_IMPLEMENTED
+
+#include <stdio.h>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "saw_io.h"
+
+namespace saw {
+
+	struct ProfRegistry {
+		std::mutex lock;
+		std::vector<ProfThread *> threads;
+		unsigned long long baseTicks;  // At the first probe
+		std::chrono::steady_clock::time_point baseTime;
+		bool started;
+		ProfRegistry() : baseTicks(0), started(false) { }
+	};
+
+	static ProfRegistry &ProfGetRegistry() {
+		static ProfRegistry registry;
+		return registry;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	ProfThread *ProfAddThread() {
+		ProfThread *t = new ProfThread;
+		t->begun.store(0);
+		t->head.store(0);
+		ProfRegistry &r = ProfGetRegistry();
+		{
+			std::lock_guard<std::mutex> guard(r.lock);
+			if (!r.started) {
+				r.baseTicks = ProfGetTicks();
+				r.baseTime = std::chrono::steady_clock::now();
+				r.started = true;
+			}
+			t->id = static_cast<int>(r.threads.size());
+			r.threads.push_back(t);
+		}
+		ProfGetThreadRef() = t;
+		return t;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	// Ticks per microsecond, from the ticks and time passed since the first probe (at least 10 ms of it).
+	// Call without the registry lock, as it may sleep.
+	static double ProfGetTicksPerUs(unsigned long long baseTicks, std::chrono::steady_clock::time_point baseTime) {
+#ifdef SAW_PROF_RDTSC
+		std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - baseTime;
+		if (elapsed < std::chrono::milliseconds(10))
+			std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+		unsigned long long ticks = ProfGetTicks() - baseTicks;
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - baseTime).count();
+		return ticks / us;
+#else
+		(void)baseTicks;
+		(void)baseTime;
+		return static_cast<double>(std::chrono::steady_clock::period::den) / std::chrono::steady_clock::period::num / 1000000;
+#endif
+	}
+
+	static bool ProfSpanLess(const ProfSpan &a, const ProfSpan &b) {
+		return a.start < b.start || (a.start == b.start && a.duration > b.duration);  // Enclosing scope first
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	struct ProfEventCopy {
+		const char *name;
+		unsigned long long start, end;
+	};
+
+	void ProfCollect(std::vector<ProfSpan> *pOut) {
+		pOut->clear();
+		ProfRegistry &r = ProfGetRegistry();
+		unsigned long long baseTicks;
+		std::chrono::steady_clock::time_point baseTime;
+		{
+			std::lock_guard<std::mutex> guard(r.lock);
+			if (!r.started)
+				return;
+			baseTicks = r.baseTicks;
+			baseTime = r.baseTime;
+		}
+		double ticksPerUs = ProfGetTicksPerUs(baseTicks, baseTime);
+		std::lock_guard<std::mutex> guard(r.lock);
+		std::vector<ProfEventCopy> events;
+		for (size_t i = 0; i < r.threads.size(); i++) {
+			const ProfThread *t = r.threads[i];
+			unsigned long long head = t->head.load(std::memory_order_acquire);
+			unsigned long long first = head > SAW_PROF_CAPACITY ? head - SAW_PROF_CAPACITY : 0;
+			events.resize(static_cast<size_t>(head - first));
+			for (unsigned long long e = first; e < head; e++) {
+				const ProfEvent &src = t->events[e & (SAW_PROF_CAPACITY - 1)];
+				ProfEventCopy &dst = events[static_cast<size_t>(e - first)];
+				dst.name = src.name.load(std::memory_order_relaxed);
+				dst.start = src.start.load(std::memory_order_relaxed);
+				dst.end = src.end.load(std::memory_order_relaxed);
+			}
+			// Events the thread wrote over, or was writing over, while they were copied are dropped.
+			// Any store seen above happened after its begun store, which the fence makes visible here.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			unsigned long long begun = t->begun.load(std::memory_order_relaxed);
+			unsigned long long valid = begun > SAW_PROF_CAPACITY ? begun - SAW_PROF_CAPACITY : 0;
+			for (unsigned long long e = first > valid ? first : valid; e < head; e++) {
+				const ProfEventCopy &ev = events[static_cast<size_t>(e - first)];
+				ProfSpan span;
+				span.name = ev.name;
+				span.start = static_cast<long long>(ev.start - r.baseTicks) / ticksPerUs;
+				span.duration = (ev.end - ev.start) / ticksPerUs;
+				span.thread = t->id;
+				pOut->push_back(span);
+			}
+		}
+		std::stable_sort(pOut->begin(), pOut->end(), ProfSpanLess);
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	bool ProfWriteChromeTrace(const Io *io) {
+		if (!io)
+			return false;
+		std::vector<ProfSpan> spans;
+		ProfCollect(&spans);
+		std::string out = "{\"traceEvents\":[\n";
+		char buf[128];
+		for (size_t i = 0; i < spans.size(); i++) {
+			out += "{\"name\":\"";
+			for (const char *c = spans[i].name; *c; c++) {
+				if (*c == '"' || *c == '\\')
+					out += '\\';
+				if (static_cast<unsigned char>(*c) >= ' ')
+					out += *c;
+			}
+			snprintf(buf, sizeof(buf), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+				spans[i].thread, spans[i].start, spans[i].duration, i + 1 < spans.size() ? "," : "");
+			out += buf;
+		}
+		out += "],\"displayTimeUnit\":\"ms\"}\n";
+		IoWriteRaw(io, out.size(), out.data());
+		return true;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	void ProfClear() {
+		ProfRegistry &r = ProfGetRegistry();
+		std::lock_guard<std::mutex> guard(r.lock);
+		for (size_t i = 0; i < r.threads.size(); i++) {
+			r.threads[i]->begun.store(0);
+			r.threads[i]->head.store(0);
+		}
+	}
+
+}  // namespace
+
+#endif  // SAW_PROF_IMPLEMENTATION
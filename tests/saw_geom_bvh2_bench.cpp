@@ -0,0 +1,139 @@
+// Query cost of the node layouts of large hierarchies: depth first, van Emde Boas, and both quantized.
+// Reports nanoseconds and, on linux where perf counters are allowed, last level cache misses per query.
+// Usage: saw_geom_bvh2_bench [boxes (default 4000000)] [queries (default 200000)]
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#define SAW_JOB_IMPLEMENTATION
+#include "saw_geom_bvh2.h"
+#ifdef __linux__
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+// Hardware cache miss counter of this thread, or -1 when not available
+static int CacheMissesOpen() {
+#ifdef __linux__
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+	return -1;
+#endif
+}
+
+static void CacheMissesStart(int fd) {
+#ifdef __linux__
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#else
+	(void)fd;
+#endif
+}
+
+static long long CacheMissesStop(int fd) {
+	long long count = -1;
+#ifdef __linux__
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(fd, &count, sizeof(count)) != sizeof(count))
+			count = -1;
+	}
+#else
+	(void)fd;
+#endif
+	return count;
+}
+
+template <class T> static void Bench(const char *name, const T &bvh, const std::vector<Aabb2> &boxes,
+	const std::vector<Aabb2> &queries, int fd) {
+	std::vector<unsigned int> found;
+	size_t hits = 0;
+	CacheMissesStart(fd);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t q = 0; q < queries.size(); q++) {
+		Bvh2QueryAabb(bvh, &boxes[0], queries[q], &found);
+		hits += found.size();
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	long long misses = CacheMissesStop(fd);
+	cout << name << ": " << ns / queries.size() << " ns/query";
+	if (misses >= 0)
+		cout << ", " << static_cast<double>(misses) / queries.size() << " cache misses/query";
+	cout << " (" << hits << " hits)\r\n";
+}
+
+int main(int argc, char **argv) {
+	size_t n = argc > 1 ? strtoul(argv[1], 0, 10) : 4000000;
+	size_t numQueries = argc > 2 ? strtoul(argv[2], 0, 10) : 200000;
+	if (n == 0 || numQueries == 0)
+		return 1;
+	srand(1);
+
+	// Small boxes over a square, density independent of n
+	float side = static_cast<float>(sqrt(static_cast<double>(n))) * 10;
+	std::vector<Aabb2> boxes(n);
+	for (size_t i = 0; i < n; i++) {
+		float x = RandF(0, side), y = RandF(0, side);
+		boxes[i] = Aabb2(x, y, x + RandF(0, 4), y + RandF(0, 4));
+	}
+	// Morton order, as static geometry would be stored, so primitive bounds cost little next to the nodes
+	std::vector<unsigned int> keys(n), perm(n);
+	Morton2Scratch sortScratch;
+	std::vector<Aabb2> temp;
+	Morton2CalcKeys(&boxes[0], n, &keys[0]);
+	Morton2Sort(0, &keys[0], n, &perm[0], &sortScratch);
+	Morton2Permute(&boxes, &perm[0], &temp);
+	std::vector<Aabb2> queries(numQueries);
+	for (size_t i = 0; i < numQueries; i++) {
+		float x = RandF(0, side), y = RandF(0, side);
+		queries[i] = Aabb2(x, y, x + 10, y + 10);
+	}
+
+	saw::JobPool pool;
+	saw::JobPoolInit(&pool, 0);
+	Bvh2BuildScratch scratch;
+	Bvh2<4> depthFirst;
+	Bvh2Build(&pool, &boxes[0], n, &depthFirst, &scratch);
+	Bvh2<4> veb = depthFirst;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Bvh2LayoutVeb(&veb);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	Bvh2Q<4> quantDepthFirst, quantVeb;
+	Bvh2Quantize(&pool, depthFirst, &quantDepthFirst);
+	Bvh2Quantize(&pool, veb, &quantVeb);
+	saw::JobPoolFree(&pool);
+
+	cout << n << " boxes, " << depthFirst.nodes.size() << " nodes (" << depthFirst.nodes.size() * sizeof(Bvh2Node<4>) / (1 << 20)
+		<< " MB), Bvh2LayoutVeb " << ms << " ms, " << numQueries << " queries\r\n";
+	int fd = CacheMissesOpen();
+	if (fd < 0)
+		cout << "Cache miss counter not available (perf_event_open), timing only\r\n";
+	Bench("Bvh2<4> depth first", depthFirst, boxes, queries, fd);
+	Bench("Bvh2<4> van Emde Boas", veb, boxes, queries, fd);
+	Bench("Bvh2Q<4> depth first", quantDepthFirst, boxes, queries, fd);
+	Bench("Bvh2Q<4> van Emde Boas", quantVeb, boxes, queries, fd);
+#ifdef __linux__
+	if (fd >= 0)
+		close(fd);
+#endif
+	return 0;
+}
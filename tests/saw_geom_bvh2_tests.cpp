@@ -0,0 +1,332 @@
+#include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#define SAW_JOB_IMPLEMENTATION
+#include "saw_geom_bvh2.h"
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+struct ShapeBox {
+	Aabb2 box;
+	template <class T> void operator()(const T &prim) { box = CalcAabb2(prim); }
+};
+
+struct ShapeGap {
+	const Shape2 *shapes;
+	Shape2 query;
+	size_t *pCalls;
+	float operator()(unsigned int i) const { ++*pCalls; return Dist2Gap(query, shapes[i]); }
+};
+
+// Random shape of any type in a 100 x 100 square
+static Shape2 RandShape(int type) {
+	float x = RandF(0, 100), y = RandF(0, 100), w = RandF(0, 2), h = RandF(0, 2), angle = RandF(0, 6.3f);
+	switch (type) {
+	case PRIM2_POINT: return Shape2Make(Point2(x, y));
+	case PRIM2_AABB: return Shape2Make(Aabb2(x, y, x + w, y + h));
+	case PRIM2_OBB: return Shape2Make(Obb2(x, y, cos(angle), sin(angle), w, h));
+	case PRIM2_LINESEG: return Shape2Make(LineSeg2(x, y, x + RandF(-3, 3), y + RandF(-3, 3)));
+	case PRIM2_TRIANGLE: return Shape2Make(Triangle2(x, y, x + RandF(-3, 3), y + RandF(-3, 3), x + RandF(-3, 3), y + RandF(-3, 3)));
+	case PRIM2_CIRCLE: return Shape2Make(Circle2(x, y, w));
+	default: return Shape2Make(Capsule2(x, y, x + RandF(-3, 3), y + RandF(-3, 3), h));
+	}
+}
+
+template <int W> static bool Bvh2Same(const Bvh2<W> &a, const Bvh2<W> &b) {
+	return a.nodes.size() == b.nodes.size() && a.indices == b.indices &&
+		memcmp(&a.nodes[0], &b.nodes[0], a.nodes.size() * sizeof(a.nodes[0])) == 0;
+}
+
+// Every primitive is in exactly one leaf, and every node bounds its children
+template <int W> static bool Bvh2Valid(const Bvh2<W> &bvh, const std::vector<Aabb2> &boxes, int maxLeafSize) {
+	std::vector<int> seen(boxes.size(), 0);
+	std::vector<Aabb2> stackBox(1, bvh.bounds);
+	std::vector<unsigned int> stack(1, 0);
+	size_t visited = 0;
+	while (!stack.empty()) {
+		const Bvh2Node<W> &node = bvh.nodes[stack.back()];
+		Aabb2 parent = stackBox.back();
+		stack.pop_back();
+		stackBox.pop_back();
+		visited++;
+		for (int k = 0; k < W; k++) {
+			if (node.child[k] == BVH2_EMPTY && node.count[k] == 0)
+				continue;
+			Aabb2 box(node.minX[k], node.minY[k], node.maxX[k], node.maxY[k]);
+			if (box.minX < parent.minX || box.minY < parent.minY || box.maxX > parent.maxX || box.maxY > parent.maxY)
+				return false;
+			if (node.count[k] == 0) {
+				stack.push_back(node.child[k]);
+				stackBox.push_back(box);
+				continue;
+			}
+			if (static_cast<int>(node.count[k]) > maxLeafSize)
+				return false;
+			for (unsigned int i = node.child[k]; i < node.child[k] + node.count[k]; i++) {
+				const Aabb2 &b = boxes[bvh.indices[i]];
+				seen[bvh.indices[i]]++;
+				if (b.minX < box.minX || b.minY < box.minY || b.maxX > box.maxX || b.maxY > box.maxY)
+					return false;
+			}
+		}
+	}
+	for (size_t i = 0; i < seen.size(); i++)
+		if (seen[i] != 1)
+			return false;
+	return visited == bvh.nodes.size();
+}
+
+template <int W> static void Bvh2Tests(const std::vector<Aabb2> &boxes) {
+	size_t n = boxes.size();
+	Bvh2BuildScratch scratch;
+	Bvh2<W> serial;
+	Bvh2Build(0, boxes.empty() ? 0 : &boxes[0], n, &serial, &scratch);
+	if (n && !Bvh2Valid(serial, boxes, 4))
+		cout << "Failed Bvh2Build<" << W << "> structure with " << n << " boxes.\r\n";
+
+	// Bit-identical for any number of threads
+	for (int threads = 2; threads <= 8; threads *= 2) {
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, threads);
+		Bvh2<W> threaded;
+		Bvh2Build(&pool, boxes.empty() ? 0 : &boxes[0], n, &threaded, &scratch);
+		if (n && !Bvh2Same(serial, threaded))
+			cout << "Failed Bvh2Build<" << W << "> determinism with " << threads << " threads and " << n << " boxes.\r\n";
+		saw::JobPoolFree(&pool);
+	}
+
+	// Queries find exactly the overlapping boxes
+	for (int q = 0; q < 50; q++) {
+		float x = RandF(-10, 110), y = RandF(-10, 110);
+		Aabb2 query(x, y, x + RandF(0, 20), y + RandF(0, 20));
+		std::vector<unsigned int> found;
+		Bvh2QueryAabb(serial, boxes.empty() ? 0 : &boxes[0], query, &found);
+		std::vector<unsigned int> expected;
+		for (size_t i = 0; i < n; i++)
+			if (Cd2AA(boxes[i], query))
+				expected.push_back(static_cast<unsigned int>(i));
+		std::sort(found.begin(), found.end());
+		if (found != expected) {
+			cout << "Failed Bvh2QueryAabb<" << W << "> with " << n << " boxes.\r\n";
+			break;
+		}
+	}
+
+	// Quantized: decoded child bounds contain the float ones, and queries return the same list
+	Bvh2Q<W> quant;
+	saw::JobPool pool;
+	saw::JobPoolInit(&pool, 4);
+	Bvh2Quantize(&pool, serial, &quant);
+	saw::JobPoolFree(&pool);
+	if (quant.nodes.size() != serial.nodes.size() || quant.indices != serial.indices)
+		cout << "Failed Bvh2Quantize<" << W << "> shape with " << n << " boxes.\r\n";
+	for (size_t i = 0; i < quant.nodes.size(); i++) {
+		for (int k = 0; k < W; k++) {
+			const Bvh2Node<W> &node = serial.nodes[i];
+			if (node.minX[k] > node.maxX[k])
+				continue;
+			Aabb2 c = Bvh2QGetChildBox(quant.nodes[i], k);
+			if (!(quant.nodes[i].used & (1 << k)) || c.minX > node.minX[k] || c.minY > node.minY[k] ||
+				c.maxX < node.maxX[k] || c.maxY < node.maxY[k]) {
+				cout << "Failed Bvh2Quantize<" << W << "> bounds with " << n << " boxes.\r\n";
+				i = quant.nodes.size() - 1;
+				break;
+			}
+		}
+	}
+	for (int q = 0; q < 200; q++) {
+		Aabb2 query;
+		if (q % 2 && n) {  // Touching a box exactly
+			const Aabb2 &b = boxes[rand() % n];
+			query = Aabb2(b.maxX, b.maxY, b.maxX + RandF(0, 2), b.maxY + RandF(0, 2));
+		} else {
+			float x = RandF(-10, 110) + (n ? boxes[0].minX : 0), y = RandF(-10, 110);
+			query = Aabb2(x, y, x + RandF(0, 20), y + RandF(0, 20));
+		}
+		std::vector<unsigned int> found, expected;
+		Bvh2QueryAabb(quant, boxes.empty() ? 0 : &boxes[0], query, &found);
+		Bvh2QueryAabb(serial, boxes.empty() ? 0 : &boxes[0], query, &expected);
+		if (found != expected) {
+			cout << "Failed Bvh2QueryAabb<" << W << "> quantized with " << n << " boxes.\r\n";
+			break;
+		}
+	}
+
+	// van Emde Boas layout: same tree with root at 0 and parents first, same query lists, and stable
+	Bvh2<W> veb = serial;
+	Bvh2LayoutVeb(&veb);
+	bool vebValid = veb.nodes.size() == serial.nodes.size() && veb.indices == serial.indices && (!n || Bvh2Valid(veb, boxes, 4));
+	for (size_t i = 0; i < veb.nodes.size() && vebValid; i++)
+		for (int k = 0; k < W; k++)
+			if (veb.nodes[i].count[k] == 0 && veb.nodes[i].child[k] != BVH2_EMPTY && veb.nodes[i].child[k] <= i)
+				vebValid = false;
+	if (!vebValid)
+		cout << "Failed Bvh2LayoutVeb<" << W << "> structure with " << n << " boxes.\r\n";
+	Bvh2<W> veb2 = veb;
+	Bvh2LayoutVeb(&veb2);
+	if (n && !Bvh2Same(veb, veb2))
+		cout << "Failed Bvh2LayoutVeb<" << W << "> stable with " << n << " boxes.\r\n";
+	Bvh2Q<W> quantVeb = quant, vebQuant;
+	Bvh2LayoutVeb(&quantVeb);
+	Bvh2Quantize(0, veb, &vebQuant);
+	if (n && memcmp(&quantVeb.nodes[0], &vebQuant.nodes[0], quant.nodes.size() * sizeof(quant.nodes[0])) != 0)
+		cout << "Failed Bvh2LayoutVeb<" << W << "> quantized with " << n << " boxes.\r\n";
+	for (int q = 0; q < 50; q++) {
+		float x = RandF(-10, 110) + (n ? boxes[0].minX : 0), y = RandF(-10, 110);
+		Aabb2 query(x, y, x + RandF(0, 20), y + RandF(0, 20));
+		std::vector<unsigned int> found, foundQ, expected;
+		Bvh2QueryAabb(veb, boxes.empty() ? 0 : &boxes[0], query, &found);
+		Bvh2QueryAabb(quantVeb, boxes.empty() ? 0 : &boxes[0], query, &foundQ);
+		Bvh2QueryAabb(serial, boxes.empty() ? 0 : &boxes[0], query, &expected);
+		if (found != expected || foundQ != expected) {
+			cout << "Failed Bvh2QueryAabb<" << W << "> after Bvh2LayoutVeb with " << n << " boxes.\r\n";
+			break;
+		}
+	}
+}
+
+struct KeyLess {
+	const unsigned int *keys;
+	bool operator()(unsigned int a, unsigned int b) const { return keys[a] < keys[b]; }
+};
+
+int main() {
+	srand(1);
+
+	// Morton keys interleave x in the even bits and y in the odd bits
+	if (Morton2Encode(0, 0) != 0 || Morton2Encode(1, 0) != 1 || Morton2Encode(0, 1) != 2 || Morton2Encode(3, 3) != 15)
+		cout << "Failed Morton2Encode small values.\r\n";
+	if (Morton2Encode(0xffff, 0) != 0x55555555 || Morton2Encode(0, 0xffff) != 0xaaaaaaaa)
+		cout << "Failed Morton2Encode full range.\r\n";
+
+	// Keys follow the Z curve over the range
+	{
+		float cx[4] = { 0, 10, 0, 10 }, cy[4] = { 0, 0, 10, 10 };
+		unsigned int keys[4];
+		Morton2CalcKeys(cx, cy, 4, Aabb2(0, 0, 10, 10), keys);
+		if (!(keys[0] < keys[1] && keys[1] < keys[2] && keys[2] < keys[3]) || keys[0] != 0 || keys[3] != 0xffffffff)
+			cout << "Failed Morton2CalcKeys.\r\n";
+	}
+
+	// Radix sort is stable and matches std::stable_sort, with and without threads
+	const size_t sizes[] = { 1, 7, 1000, 100000 };
+	for (int si = 0; si < 4; si++) {
+		size_t n = sizes[si];
+		std::vector<Circle2> circles;
+		for (size_t i = 0; i < n; i++)
+			circles.push_back(Circle2(RandF(-50, 50), RandF(0, 20), RandF(0, 2)));
+		if (n > 10)
+			circles[n / 2] = circles[n / 3];  // Duplicate keys
+		std::vector<unsigned int> keys(n);
+		Morton2CalcKeys(&circles[0], n, &keys[0]);
+
+		std::vector<unsigned int> expected(n);
+		for (size_t i = 0; i < n; i++)
+			expected[i] = static_cast<unsigned int>(i);
+		KeyLess less = { &keys[0] };
+		std::stable_sort(expected.begin(), expected.end(), less);
+
+		Morton2Scratch scratch;
+		for (int threads = 1; threads <= 8; threads *= 2) {
+			saw::JobPool pool;
+			saw::JobPoolInit(&pool, threads);
+			std::vector<unsigned int> perm(n);
+			Morton2Sort(threads == 1 ? 0 : &pool, &keys[0], n, &perm[0], &scratch);
+			if (perm != expected)
+				cout << "Failed Morton2Sort of " << n << " keys with " << threads << " threads.\r\n";
+			saw::JobPoolFree(&pool);
+		}
+
+		std::vector<Circle2> sorted(n);
+		Morton2Permute(&circles[0], &expected[0], n, &sorted[0]);
+		std::vector<Circle2> inPlace = circles;
+		std::vector<Circle2> temp;
+		Morton2Permute(&inPlace, &expected[0], &temp);
+		for (size_t i = 0; i < n; i++) {
+			if (sorted[i].x != circles[expected[i]].x || inPlace[i].x != sorted[i].x || inPlace[i].y != sorted[i].y) {
+				cout << "Failed Morton2Permute at " << i << ".\r\n";
+				break;
+			}
+		}
+	}
+
+	// Hierarchies over random, clustered and coincident boxes
+	const size_t bvhSizes[] = { 0, 1, 5, 300, 30000 };
+	for (int si = 0; si < 5; si++) {
+		std::vector<Aabb2> boxes;
+		for (size_t i = 0; i < bvhSizes[si]; i++) {
+			float x = RandF(0, 100), y = i % 3 ? RandF(0, 100) : RandF(40, 41);
+			boxes.push_back(Aabb2(x, y, x + RandF(0, 3), y + RandF(0, 3)));
+		}
+		Bvh2Tests<2>(boxes);
+		Bvh2Tests<4>(boxes);
+	}
+	std::vector<Aabb2> same(100, Aabb2(5, 5, 6, 6));
+	Bvh2Tests<2>(same);
+	Bvh2Tests<4>(same);
+	std::vector<Aabb2> far;  // Far from the origin, where a step of the grid is coarse next to the floats
+	for (int i = 0; i < 3000; i++) {
+		float x = 1E+6f + RandF(0, 100), y = RandF(0, 100);
+		far.push_back(Aabb2(x, y, x + RandF(0, .1f), y + RandF(0, .1f)));
+	}
+	Bvh2Tests<4>(far);
+
+	// Nearest shape matches brute force over Dist2Gap, and opens few shapes
+	{
+		std::vector<Shape2> shapes;
+		std::vector<Aabb2> boxes;
+		for (int i = 0; i < 5000; i++) {
+			shapes.push_back(RandShape(i % PRIM2_COUNT));
+			ShapeBox b;
+			Shape2Visit(shapes.back(), b);
+			boxes.push_back(b.box);
+		}
+		Bvh2<4> bvh4;
+		Bvh2<2> bvh2;
+		Bvh2BuildScratch buildScratch;
+		Bvh2Build(0, &boxes[0], boxes.size(), &bvh4, &buildScratch);
+		Bvh2Build(0, &boxes[0], boxes.size(), &bvh2, &buildScratch);
+		Bvh2NearestScratch scratch;
+		size_t calls = 0;
+		for (int q = 0; q < 200; q++) {
+			size_t queryCalls = 0;
+			ShapeGap gap = { &shapes[0], q % 2 ? RandShape(q % PRIM2_COUNT) : Shape2Make(Point2(RandF(-20, 120), RandF(-20, 120))), &queryCalls };
+			ShapeBox qb;
+			Shape2Visit(gap.query, qb);
+			unsigned int expected = BVH2_EMPTY;
+			float best = 1E+37f;
+			for (unsigned int i = 0; i < shapes.size(); i++) {
+				float d = Dist2Gap(gap.query, shapes[i]);
+				if (d < best) {
+					best = d;
+					expected = i;
+				}
+			}
+			float d4 = -1, d2 = -1;
+			unsigned int got4 = Bvh2QueryNearest(bvh4, &boxes[0], qb.box, gap, 1E+37f, &d4, &scratch);
+			calls += queryCalls;
+			unsigned int got2 = Bvh2QueryNearest(bvh2, &boxes[0], qb.box, gap, 1E+37f, &d2, &scratch);
+			if (got4 != expected || got2 != expected || d4 != best || d2 != best)
+				cout << "Failed Bvh2QueryNearest " << q << ": " << got4 << " " << got2 << " for " << expected << ".\r\n";
+			if (Bvh2QueryNearest(bvh4, &boxes[0], qb.box, gap, best * .5f - 1E-6f, &d4, &scratch) != BVH2_EMPTY && best > 0)
+				cout << "Failed Bvh2QueryNearest beyond maxDist2 " << q << ".\r\n";
+		}
+		if (calls > 200 * 100)
+			cout << "Failed Bvh2QueryNearest pruning, " << calls << " distances for 200 queries.\r\n";
+		Bvh2<4> empty;
+		Bvh2Build(0, 0, 0, &empty, &buildScratch);
+		if (Bvh2QueryNearest(empty, &boxes[0], boxes[0], [&](unsigned int i) { return Dist2Gap(shapes[0], shapes[i]); },
+			1E+37f, 0, &scratch) != BVH2_EMPTY)
+			cout << "Failed Bvh2QueryNearest on an empty hierarchy.\r\n";
+	}
+	if (sizeof(Bvh2QNode<4>) != 64 || sizeof(Bvh2QNode<4>) * 3 > sizeof(Bvh2Node<4>) * 2)
+		cout << "Failed Bvh2QNode<4> size " << sizeof(Bvh2QNode<4>) << ".\r\n";
+
+	return 0;
+}
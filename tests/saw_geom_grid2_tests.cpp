@@ -0,0 +1,151 @@
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#define SAW_JOB_IMPLEMENTATION
+#include "saw_geom_grid2.h"
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+int main() {
+	srand(1);
+	std::vector<Shape2> shapes;
+	for (int i = 0; i < 60; i++) {
+		float x = RandF(-5, 105), y = RandF(-5, 105), rad = RandF(0, 6.2831853f);
+		switch (i % 6) {
+		case 0: shapes.push_back(Shape2Make(Aabb2(x, y, x + RandF(1, 15), y + RandF(1, 15)))); break;
+		case 1: shapes.push_back(Shape2Make(Obb2(x, y, cos(rad), sin(rad), RandF(1, 8), RandF(1, 8)))); break;
+		case 2: shapes.push_back(Shape2Make(Triangle2(x, y, x + RandF(-10, 10), y + RandF(-10, 10), x + RandF(-10, 10), y + RandF(-10, 10)))); break;
+		case 3: shapes.push_back(Shape2Make(Circle2(x, y, RandF(1, 10)))); break;
+		case 4: shapes.push_back(Shape2Make(LineSeg2(x, y, x + RandF(-10, 10), y + RandF(-10, 10)))); break;
+		default: shapes.push_back(Shape2Make(Point2(x, y))); break;
+		}
+	}
+	// Lines and points are hit exactly on a few probes below
+	shapes.push_back(Shape2Make(LineSeg2(10, 50, 30, 50)));
+	shapes.push_back(Shape2Make(Point2(62.5f, 37.5f)));
+
+	BitGrid2 grid;
+	BitGrid2Build(&grid, Aabb2(0, 0, 100, 100), 64, 48, &shapes[0], shapes.size());
+
+	// Random points, points on cell edges, and points on the extra line and point
+	std::vector<float> px, py;
+	for (int i = 0; i < 20000; i++) {
+		px.push_back(RandF(-10, 110));
+		py.push_back(RandF(-10, 110));
+	}
+	for (int i = 0; i <= 64; i++) {
+		px.push_back(i * 100.0f / 64);
+		py.push_back(RandF(0, 100));
+	}
+	for (int i = 0; i < 21; i++) {
+		px.push_back(10 + i);
+		py.push_back(50);
+	}
+	px.push_back(62.5f);
+	py.push_back(37.5f);
+
+	std::vector<unsigned char> expected(px.size());
+	size_t hits = 0;
+	for (size_t i = 0; i < px.size(); i++) {
+		Shape2 p = Shape2Make(Point2(px[i], py[i]));
+		for (size_t j = 0; j < shapes.size() && !expected[i]; j++)
+			expected[i] = Cd2(p, shapes[j]);
+		hits += expected[i];
+	}
+	if (hits == 0 || hits == px.size())
+		cout << "Failed BitGrid2 test setup.\r\n";
+
+	bool *batch = new bool[px.size()];
+	BitGrid2TestPoints(grid, &px[0], &py[0], px.size(), batch);
+	for (size_t i = 0; i < px.size(); i++) {
+		if (BitGrid2TestPoint(grid, px[i], py[i]) != (expected[i] != 0))
+			cout << "Failed BitGrid2TestPoint at " << px[i] << ", " << py[i] << ".\r\n";
+		if (batch[i] != (expected[i] != 0))
+			cout << "Failed BitGrid2TestPoints at " << px[i] << ", " << py[i] << ".\r\n";
+	}
+	delete[] batch;
+
+	// Points on all four edges of the grid, with shapes touching each edge from inside
+	{
+		Shape2 edgeShapes[2] = { Shape2Make(Aabb2(2, 2, 10, 10)), Shape2Make(Aabb2(0, 0, 1, 1)) };
+		BitGrid2 edge;
+		BitGrid2Build(&edge, Aabb2(0, 0, 10, 10), 10, 10, edgeShapes, 2);
+		float ex[12] = { 10, 5, 10, 0, .5f, 0, 10, 1.5f, 10.001f, 5, 0, -.001f };
+		float ey[12] = { 5, 10, 10, .5f, 0, 0, 1, 10, 5, 10.001f, 5, .5f };
+		bool edgeBatch[12];
+		BitGrid2TestPoints(edge, ex, ey, 12, edgeBatch);
+		for (int i = 0; i < 12; i++) {
+			bool hit = Cd2(Point2(ex[i], ey[i]), Shape2Get<Aabb2>(edgeShapes[0])) || Cd2(Point2(ex[i], ey[i]), Shape2Get<Aabb2>(edgeShapes[1]));
+			if (BitGrid2TestPoint(edge, ex[i], ey[i]) != hit || edgeBatch[i] != hit)
+				cout << "Failed BitGrid2 on the edge at " << ex[i] << ", " << ey[i] << ".\r\n";
+		}
+	}
+
+	// Most cells are decided by the bits alone
+	size_t listed = 0;
+	for (size_t c = 0; c < grid.cellStart.size() - 1; c++)
+		listed += grid.cellStart[c + 1] != grid.cellStart[c];
+	if (listed * 2 > static_cast<size_t>(grid.width) * grid.height)
+		cout << "Failed BitGrid2 boundary cell count.\r\n";
+
+	// Signed distance field against the distance to every shape
+	{
+		Sdf2 sdf, sdfSerial;
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, 4);
+		Sdf2Build(&pool, &sdf, Aabb2(-10, -10, 110, 110), 121, 97, &shapes[0], shapes.size());
+		saw::JobPoolFree(&pool);
+		Sdf2Build(0, &sdfSerial, Aabb2(-10, -10, 110, 110), 121, 97, &shapes[0], shapes.size());
+		if (sdf.dist != sdfSerial.dist || sdf.nearest != sdfSerial.nearest)
+			cout << "Failed Sdf2Build threads differ.\r\n";
+
+		size_t wrong = 0;
+		for (int y = 0; y < sdf.height; y++) {
+			for (int x = 0; x < sdf.width; x++) {
+				float sx = sdf.bounds.minX + x * sdf.stepX, sy = sdf.bounds.minY + y * sdf.stepY, brute = 1E+37f;
+				for (size_t j = 0; j < shapes.size(); j++) {
+					float d = Sdf2GetShapeDist(shapes[j], sx, sy);
+					brute = d < brute ? d : brute;
+				}
+				wrong += fabs(sdf.dist[y * sdf.width + x] - brute) > 1E-3f;
+			}
+		}
+		if (wrong * 200 > sdf.dist.size())
+			cout << "Failed Sdf2Build samples: " << wrong << " of " << sdf.dist.size() << " wrong.\r\n";
+
+		std::vector<float> qx(2000), qy(2000), approx(2000), refined(2000);
+		for (size_t i = 0; i < qx.size(); i++) {
+			qx[i] = RandF(-10, 110);
+			qy[i] = RandF(-10, 110);
+		}
+		float band = 2 * (sdf.stepX > sdf.stepY ? sdf.stepX : sdf.stepY);
+		Sdf2SampleBatch(sdf, &qx[0], &qy[0], qx.size(), 0, &approx[0]);
+		Sdf2SampleBatch(sdf, &qx[0], &qy[0], qx.size(), band, &refined[0]);
+		size_t far = 0, inexact = 0, nearSurface = 0;
+		for (size_t i = 0; i < qx.size(); i++) {
+			float brute = 1E+37f;
+			for (size_t j = 0; j < shapes.size(); j++) {
+				float d = Sdf2GetShapeDist(shapes[j], qx[i], qy[i]);
+				brute = d < brute ? d : brute;
+			}
+			if (approx[i] != Sdf2Sample(sdf, qx[i], qy[i]))
+				cout << "Failed Sdf2SampleBatch at " << qx[i] << ", " << qy[i] << ".\r\n";
+			far += fabs(approx[i] - brute) > band;
+			if (fabs(approx[i]) < band) {
+				nearSurface++;
+				inexact += fabs(refined[i] - brute) > 1E-3f;
+			}
+		}
+		if (far * 100 > qx.size())
+			cout << "Failed Sdf2Sample: " << far << " samples off by more than " << band << ".\r\n";
+		if (nearSurface == 0 || inexact * 50 > nearSurface)
+			cout << "Failed Sdf2Sample refinement: " << inexact << " of " << nearSurface << " inexact.\r\n";
+	}
+
+	return 0;
+}
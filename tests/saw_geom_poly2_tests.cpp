@@ -0,0 +1,210 @@
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#define SAW_JOB_IMPLEMENTATION
+#include "saw_geom_poly2.h"
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+// Strictly convex, counter-clockwise and containing every input point
+static bool HullValid(const float *px, const float *py, int n, const float *hx, const float *hy, int count) {
+	if (n == 0)
+		return count == 0;
+	if (count < 3)
+		return count >= 1;
+	for (int i = 0; i < count; i++) {
+		int j = (i + 1) % count, k = (i + 2) % count;
+		if ((hx[j] - hx[i]) * (hy[k] - hy[i]) - (hy[j] - hy[i]) * (hx[k] - hx[i]) <= 0)
+			return false;
+	}
+	for (int p = 0; p < n; p++) {
+		for (int i = 0; i < count; i++) {
+			int j = (i + 1) % count;
+			if ((hx[j] - hx[i]) * (py[p] - hy[i]) - (hy[j] - hy[i]) * (px[p] - hx[i]) < -1E-3f)
+				return false;
+		}
+	}
+	return true;
+}
+
+int main() {
+	srand(1);
+
+	// Square with interior, duplicate and collinear points
+	{
+		float px[] = { 0, 1, 1, 0, .5f, .5f, 1, 0, 1, .25f };
+		float py[] = { 0, 0, 1, 1, .5f, 0, .5f, 0, 1, .75f };
+		float hx[10], hy[10];
+		std::vector<unsigned int> work(ConvexHull2GetWorkSize(10));
+		int count = ConvexHull2(px, py, 10, hx, hy, &work[0]);
+		if (count != 4 || !HullValid(px, py, 10, hx, hy, count))
+			cout << "Failed ConvexHull2 of square.\r\n";
+		float tx[] = { .5f, 2, .5f }, ty[] = { .5f, .5f, 2 };
+		if (!Cd2NN(hx, hy, count, tx, ty, 3))
+			cout << "Failed Cd2NN with ConvexHull2 output.\r\n";
+		float fx[] = { 2, 3, 2 }, fy[] = { 2, 2, 3 };
+		if (Cd2NN(hx, hy, count, fx, fy, 3))
+			cout << "Failed Cd2NN with separated ConvexHull2 output.\r\n";
+	}
+
+	// Degenerate inputs
+	{
+		float px[] = { 3, 3, 3, 1, 2 }, py[] = { 4, 4, 4, 2, 3 };
+		float hx[5], hy[5];
+		unsigned int work[20];
+		if (ConvexHull2(px, py, 0, hx, hy, work) != 0)
+			cout << "Failed ConvexHull2 of no points.\r\n";
+		if (ConvexHull2(px, py, 3, hx, hy, work) != 1 || hx[0] != 3 || hy[0] != 4)
+			cout << "Failed ConvexHull2 of one repeated point.\r\n";
+		if (ConvexHull2(px, py, 5, hx, hy, work) != 2)
+			cout << "Failed ConvexHull2 of collinear points.\r\n";
+	}
+
+	// Random clouds, both the insertion and the radix sort path
+	const int sizes[] = { 3, 10, 32, 33, 100, 5000 };
+	for (int si = 0; si < 6; si++) {
+		int n = sizes[si];
+		std::vector<float> px(n), py(n), hx(n), hy(n);
+		for (int i = 0; i < n; i++) {
+			float a = RandF(0, 6.2831853f), r = RandF(0, 50);
+			px[i] = cos(a) * r - 20;
+			py[i] = sin(a) * r + 10;
+		}
+		std::vector<unsigned int> work(ConvexHull2GetWorkSize(n));
+		int count = ConvexHull2(&px[0], &py[0], n, &hx[0], &hy[0], &work[0]);
+		if (!HullValid(&px[0], &py[0], n, &hx[0], &hy[0], count))
+			cout << "Failed ConvexHull2 of " << n << " random points.\r\n";
+	}
+
+	// Batch matches single hulls, with and without threads
+	{
+		const int numHulls = 1000;
+		std::vector<int> offsets(1, 0);
+		std::vector<float> px, py;
+		for (int h = 0; h < numHulls; h++) {
+			int n = rand() % 40;
+			for (int i = 0; i < n; i++) {
+				px.push_back(RandF(-10, 10));
+				py.push_back(RandF(-10, 10));
+			}
+			offsets.push_back(offsets.back() + n);
+		}
+		size_t total = px.size();
+		std::vector<float> hx(total), hy(total), sx(total), sy(total);
+		std::vector<int> counts(numHulls);
+		std::vector<unsigned int> work(ConvexHull2GetWorkSize(static_cast<int>(total)));
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, 4);
+		for (int pass = 0; pass < 2; pass++) {
+			ConvexHull2Batch(pass ? &pool : 0, &px[0], &py[0], &offsets[0], numHulls, &hx[0], &hy[0], &counts[0], &work[0]);
+			for (int h = 0; h < numHulls; h++) {
+				int first = offsets[h], n = offsets[h + 1] - first;
+				int count = ConvexHull2(&px[first], &py[first], n, &sx[first], &sy[first], &work[0]);
+				bool same = count == counts[h];
+				for (int i = 0; same && i < count; i++)
+					same = sx[first + i] == hx[first + i] && sy[first + i] == hy[first + i];
+				if (!same) {
+					cout << "Failed ConvexHull2Batch hull " << h << " pass " << pass << ".\r\n";
+					break;
+				}
+			}
+		}
+		saw::JobPoolFree(&pool);
+	}
+
+	// Non-convex polygon: wavy outer ring with a hole, against the crossing test over every edge
+	{
+		const int NV = 3000, NH = 40;
+		std::vector<float> px, py;
+		for (int i = 0; i < NV; i++) {
+			float a = i * 6.2831853f / NV, r = 35 + 12 * sin(7 * a) + RandF(-1, 1);  // Wavy, like a traced outline
+			px.push_back(r * cos(a));
+			py.push_back(r * sin(a));
+		}
+		for (int i = 0; i < NH; i++) {
+			px.push_back(5 * cos(i * 6.2831853f / NH));
+			py.push_back(5 * sin(i * 6.2831853f / NH));
+		}
+		int rings[3] = { 0, NV, NV + NH };
+		Poly2 poly;
+		Poly2BuildRings(&poly, &px[0], &py[0], rings, 2);
+		if (poly.slabEdges.size() > 4 * px.size())
+			cout << "Failed Poly2BuildRings slab edge count " << poly.slabEdges.size() << ".\r\n";
+
+		const size_t NQ = 5000;
+		std::vector<float> qx(NQ), qy(NQ);
+		for (size_t i = 0; i < NQ; i++) {
+			qx[i] = RandF(-55, 55);
+			qy[i] = RandF(-55, 55);
+		}
+		qy[0] = poly.bounds.minY;  // Bottom and top slab edges
+		qy[1] = poly.bounds.maxY;
+		bool *serial = new bool[NQ], *pooled = new bool[NQ];
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, 4);
+		Poly2TestPoints(0, poly, &qx[0], &qy[0], NQ, serial);
+		Poly2TestPoints(&pool, poly, &qx[0], &qy[0], NQ, pooled);
+		saw::JobPoolFree(&pool);
+		size_t inside = 0;
+		for (size_t q = 0; q < NQ; q++) {
+			bool expected = false;
+			for (int r = 0; r < 2; r++)
+				for (int i = rings[r], j = rings[r + 1] - 1; i < rings[r + 1]; j = i++)
+					if ((py[j] > qy[q]) != (py[i] > qy[q]) && qx[q] < (px[i] - px[j]) * (qy[q] - py[j]) / (py[i] - py[j]) + px[j])
+						expected = !expected;
+			inside += expected;
+			if (serial[q] != expected || pooled[q] != expected)
+				cout << "Failed Poly2TestPoints at " << qx[q] << ", " << qy[q] << ".\r\n";
+		}
+		if (inside == 0 || inside == NQ)
+			cout << "Failed Poly2TestPoints setup.\r\n";
+		delete[] serial;
+		delete[] pooled;
+
+		// Convex decomposition of the outer ring, both windings
+		for (int reverse = 0; reverse < 2; reverse++) {
+			const int ND = 400;
+			std::vector<float> dx(ND), dy(ND);
+			float area = 0;
+			for (int i = 0; i < ND; i++) {
+				int k = reverse ? ND - 1 - i : i;
+				float r = k % 2 ? RandF(10, 20) : RandF(30, 50), a = k * 6.2831853f / ND;
+				dx[i] = r * cos(a);
+				dy[i] = r * sin(a);
+			}
+			for (int i = 0, j = ND - 1; i < ND; j = i++)
+				area += (dx[j] * dy[i] - dx[i] * dy[j]) * .5f;
+			Poly2Convex pieces;
+			Poly2Decompose(&dx[0], &dy[0], ND, &pieces);
+			int numPieces = Poly2GetNumPieces(pieces);
+			float pieceArea = 0;
+			for (int p = 0; p < numPieces; p++) {
+				int first = pieces.offsets[p], count = pieces.offsets[p + 1] - first;
+				for (int i = 0; i < count; i++) {
+					int j = (i + 1) % count, k = (i + 2) % count;
+					if ((pieces.x[first + j] - pieces.x[first + i]) * (pieces.y[first + k] - pieces.y[first + i]) -
+						(pieces.y[first + j] - pieces.y[first + i]) * (pieces.x[first + k] - pieces.x[first + i]) < -1E-3f)
+						cout << "Failed Poly2Decompose piece " << p << " not convex.\r\n";
+					pieceArea += (pieces.x[first + i] * pieces.y[first + j] - pieces.x[first + j] * pieces.y[first + i]) * .5f;
+				}
+			}
+			if (numPieces < 2 || numPieces > ND - 2 || fabs(pieceArea - fabs(area)) > fabs(area) * 1E-3f)
+				cout << "Failed Poly2Decompose: " << numPieces << " pieces, area " << pieceArea << " of " << area << ".\r\n";
+
+			Poly2 whole;
+			Poly2Build(&whole, &dx[0], &dy[0], ND);
+			for (int q = 0; q < 2000; q++) {
+				float x = RandF(-55, 55), y = RandF(-55, 55);
+				if (Poly2ConvexOverlapN(pieces, &x, &y, 1) != Poly2TestPoint(whole, x, y))
+					cout << "Failed Poly2ConvexOverlapN at " << x << ", " << y << ".\r\n";
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <stdlib.h>
+#define SAW_IO_IMPLEMENTATION
+#define SAW_JOB_IMPLEMENTATION
+#include "saw_geom_scene2.h"
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+int main() {
+	srand(1);
+	std::vector<Triangle2> tris;
+	std::vector<Obb2> obbs;
+	for (int i = 0; i < 1000; i++) {
+		float x = RandF(0, 100), y = RandF(0, 100);
+		tris.push_back(Triangle2(x, y, x + RandF(-3, 3), y + RandF(-3, 3), x + RandF(-3, 3), y + RandF(-3, 3)));
+	}
+	for (int i = 0; i < 7; i++)
+		obbs.push_back(Obb2(RandF(0, 10), RandF(0, 10), 1, 0, RandF(1, 2), RandF(1, 2)));
+	std::vector<Aabb2> boxes;
+	for (size_t i = 0; i < tris.size(); i++)
+		boxes.push_back(CalcAabb2(tris[i]));
+	Bvh2BuildScratch scratch;
+	Bvh2<4> bvh;
+	Bvh2Build(0, &boxes[0], boxes.size(), &bvh, &scratch);
+
+	// Write through a memory stream
+	Scene2Builder builder;
+	Scene2AddPrims(&builder, &tris[0], tris.size());
+	Scene2AddPrims(&builder, &obbs[0], obbs.size());
+	Scene2AddBvh(&builder, PRIM2_TRIANGLE, bvh, &boxes[0], boxes.size());
+	std::vector<unsigned char> file;
+	saw::Io io;
+	saw::IoOpenVec(&io, &file);
+	Scene2Write(&io, builder);
+	saw::IoClose(&io);
+	if (file.size() % SCENE2_ALIGN)
+		cout << "Failed Scene2Write size alignment.\r\n";
+
+	// Load through a stream
+	Scene2 scene;
+	saw::IoOpenMem(&io, &file[0], file.size());
+	if (!Scene2Load(&io, &scene))
+		cout << "Failed Scene2Load.\r\n";
+	saw::IoClose(&io);
+
+	// Open in place, as a mapped file would be
+	std::vector<unsigned long long> mapped((file.size() + 7) / 8);
+	memcpy(&mapped[0], &file[0], file.size());
+	Scene2View inPlace;
+	if (!Scene2Open(&mapped[0], file.size(), &inPlace))
+		cout << "Failed Scene2Open.\r\n";
+
+	const Scene2View *views[2] = { &scene.view, &inPlace };
+	for (int vi = 0; vi < 2; vi++) {
+		const Scene2View &v = *views[vi];
+		Scene2Prims prims;
+		if (!Scene2GetPrims(v, PRIM2_TRIANGLE, &prims) || prims.count != tris.size() ||
+			(reinterpret_cast<const unsigned char *>(prims.comps[0]) - v.base) % SCENE2_ALIGN ||
+			(reinterpret_cast<const unsigned char *>(prims.comps[5]) - v.base) % SCENE2_ALIGN) {
+			cout << "Failed Scene2GetPrims of triangles.\r\n";
+			continue;
+		}
+		for (size_t i = 0; i < tris.size(); i++)
+			if (prims.comps[0][i] != tris[i].x1 || prims.comps[3][i] != tris[i].y2 || prims.comps[5][i] != tris[i].y3)
+				cout << "Failed Scene2GetPrims triangle " << i << ".\r\n";
+		if (!Scene2GetPrims(v, PRIM2_OBB, &prims) || prims.count != obbs.size() || prims.comps[4][6] != obbs[6].halfW)
+			cout << "Failed Scene2GetPrims of obbs.\r\n";
+		if (Scene2GetPrims(v, PRIM2_CIRCLE, &prims))
+			cout << "Failed Scene2GetPrims of missing type.\r\n";
+
+		// The stored hierarchy answers like the original
+		Bvh2View<4> stored;
+		const Aabb2 *storedBoxes = 0;
+		Bvh2View<2> wrongWidth;
+		if (!Scene2GetBvh(v, PRIM2_TRIANGLE, &stored, &storedBoxes) || Scene2GetBvh(v, PRIM2_TRIANGLE, &wrongWidth, &storedBoxes)) {
+			cout << "Failed Scene2GetBvh.\r\n";
+			continue;
+		}
+		if (stored.bounds != bvh.bounds)
+			cout << "Failed Scene2GetBvh bounds.\r\n";
+		std::vector<unsigned int> expected, found;
+		Aabb2 query(20, 20, 40, 35);
+		Bvh2QueryAabb(bvh, &boxes[0], query, &expected);
+		Bvh2QueryAabb(stored, storedBoxes, query, &found);
+		if (found != expected || found.empty())
+			cout << "Failed Bvh2QueryAabb of stored hierarchy.\r\n";
+	}
+
+	// Damaged files are rejected
+	Scene2View bad;
+	std::vector<unsigned long long> damaged = mapped;
+	reinterpret_cast<unsigned int *>(&damaged[0])[0] ^= 1;
+	if (Scene2Open(&damaged[0], file.size(), &bad))
+		cout << "Failed Scene2Open of bad magic.\r\n";
+	if (Scene2Open(&mapped[0], file.size() - SCENE2_ALIGN, &bad))
+		cout << "Failed Scene2Open of truncated file.\r\n";
+	damaged = mapped;
+	reinterpret_cast<unsigned int *>(&damaged[0])[SCENE2_HEADER_WORDS + 4] += 4;  // Misaligned section offset
+	if (Scene2Open(&damaged[0], file.size(), &bad))
+		cout << "Failed Scene2Open of misaligned section.\r\n";
+
+	return 0;
+}
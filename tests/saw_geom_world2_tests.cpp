@@ -0,0 +1,643 @@
+#include <iostream>
+#include <set>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#define SAW_GEOM_CD2_STATS
+#define SAW_JOB_IMPLEMENTATION
+#define SAW_PROF
+#define SAW_PROF_IMPLEMENTATION
+#include "saw_geom_world2.h"
+
+using std::cout;
+using namespace sawg;
+
+static float RandF(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+static bool WriteString(void *handle, size_t bytes, const void *pIn) {
+	static_cast<std::string *>(handle)->append(static_cast<const char *>(pIn), bytes);
+	return true;
+}
+
+// One simulated frame for the rollback test, driven only by the frame number
+struct RollbackSim {
+	World2 world;
+	Contact2Cache cache;
+	Bvh2<4> bvh;
+	std::vector<World2Handle> handles;
+	std::vector<Cd2Pair> pairs;
+	std::vector<unsigned int> hits;
+	std::vector<Aabb2> bounds;
+	World2PairScratch pairScratch;
+	Cd2NarrowScratch narrowScratch;
+	Bvh2BuildScratch bvhScratch;
+};
+
+static void RollbackStep(RollbackSim *pSim, unsigned int frame) {
+	unsigned int seed = frame * 2654435761u + 1;
+	for (int i = 0; i < 20; i++) {
+		seed = seed * 1664525 + 1013904223;
+		World2Handle h = pSim->handles[(seed >> 8) % pSim->handles.size()];
+		Aabb2 a;
+		if (World2Get(&pSim->world, h, &a)) {
+			float dx = ((seed >> 4) & 15) * .1f - .75f;
+			World2Set(&pSim->world, h, Aabb2(a.minX + dx, a.minY - dx, a.maxX + dx, a.maxY - dx));
+		}
+	}
+	if (frame % 3 == 0) {
+		World2Remove(&pSim->world, pSim->handles[frame * 7 % pSim->handles.size()]);
+		float x = (frame * 37 % 100) * 1.f;
+		pSim->handles.push_back(World2Add(&pSim->world, Circle2(x, 100 - x, 2)));
+	}
+	World2FindPairs(&pSim->world, &pSim->pairs, &pSim->pairScratch);
+	Prim2View views[PRIM2_COUNT];
+	World2GetViews(&pSim->world, views);
+	pSim->hits.clear();
+	if (!pSim->pairs.empty())
+		Cd2NarrowPhase(0, views, &pSim->pairs[0], pSim->pairs.size(), &pSim->hits, &pSim->narrowScratch);
+	Contact2CacheUpdate(&pSim->cache, &pSim->world, pSim->pairs.empty() ? 0 : &pSim->pairs[0],
+		pSim->hits.empty() ? 0 : &pSim->hits[0], pSim->hits.size());
+	pSim->bounds.clear();
+	for (size_t i = 0; i < pSim->handles.size(); i++) {
+		Aabb2 b;
+		if (World2GetBounds(&pSim->world, pSim->handles[i], &b))
+			pSim->bounds.push_back(b);
+	}
+	Bvh2Build(0, &pSim->bounds[0], pSim->bounds.size(), &pSim->bvh, &pSim->bvhScratch);
+}
+
+// Every byte of rollback state, to compare states
+struct StatePacker {
+	std::vector<unsigned char> bytes;
+	template <class T> void operator()(const std::vector<T> &a) {
+		Value(a.size());
+		const unsigned char *p = reinterpret_cast<const unsigned char *>(a.empty() ? 0 : &a[0]);
+		bytes.insert(bytes.end(), p, p + a.size() * sizeof(T));
+	}
+	template <class T> void Value(const T &value) {
+		const unsigned char *p = reinterpret_cast<const unsigned char *>(&value);
+		bytes.insert(bytes.end(), p, p + sizeof(T));
+	}
+};
+
+static std::vector<unsigned char> PackState(const World2 *w, const Contact2Cache *pCache, const Bvh2<4> *pBvh) {
+	StatePacker packer;
+	World2RollbackVisit(packer, w, pCache, pBvh);
+	return packer.bytes;
+}
+
+static void SumTask(size_t task, int, void *user) {
+	static_cast<std::atomic<size_t> *>(user)->fetch_add(task + 1);
+}
+
+int main() {
+	srand(1);
+	const int N = 300;
+	std::vector<Point2> points;
+	std::vector<Aabb2> aabbs;
+	std::vector<Obb2> obbs;
+	std::vector<LineSeg2> segs;
+	std::vector<Triangle2> tris;
+	std::vector<Circle2> circles;
+	std::vector<Capsule2> caps;
+	for (int i = 0; i < N; i++) {
+		float x = RandF(0, 100), y = RandF(0, 100), rad = RandF(0, 6.2831853f);
+		points.push_back(Point2(x, y));
+		aabbs.push_back(Aabb2(x, y, x + RandF(1, 10), y + RandF(1, 10)));
+		obbs.push_back(Obb2(x, y, cos(rad), sin(rad), RandF(-5, 5), RandF(-5, 5)));
+		segs.push_back(LineSeg2(x, y, x + RandF(-10, 10), y + RandF(-10, 10)));
+		tris.push_back(Triangle2(x, y, x + RandF(-10, 10), y + RandF(-10, 10), x + RandF(-10, 10), y + RandF(-10, 10)));
+		circles.push_back(Circle2(x, y, RandF(1, 8)));
+		caps.push_back(Capsule2(x, y, x + RandF(-10, 10), y + RandF(-10, 10), RandF(.5f, 4)));
+	}
+	Prim2View views[PRIM2_COUNT];
+	views[PRIM2_POINT] = Prim2ViewAos(&points[0], points.size());
+	views[PRIM2_AABB] = Prim2ViewAos(&aabbs[0], aabbs.size());
+	views[PRIM2_OBB] = Prim2ViewAos(&obbs[0], obbs.size());
+	views[PRIM2_LINESEG] = Prim2ViewAos(&segs[0], segs.size());
+	views[PRIM2_TRIANGLE] = Prim2ViewAos(&tris[0], tris.size());
+	views[PRIM2_CIRCLE] = Prim2ViewAos(&circles[0], circles.size());
+	views[PRIM2_CAPSULE] = Prim2ViewAos(&caps[0], caps.size());
+
+	// Random pairs of every type combination
+	std::vector<Cd2Pair> pairs;
+	for (int i = 0; i < 20000; i++) {
+		Prim2Type ta = static_cast<Prim2Type>(rand() % PRIM2_COUNT), tb = static_cast<Prim2Type>(rand() % PRIM2_COUNT);
+		pairs.push_back(Cd2Pair(Prim2MakeRef(ta, rand() % N), Prim2MakeRef(tb, rand() % N)));
+	}
+
+	// Views must load what the arrays hold
+	float soaX[2] = { 1, 2 }, soaY[2] = { 3, 4 }, soaR[2] = { 5, 6 };
+	const float *soa[3] = { soaX, soaY, soaR };
+	Circle2 c = Prim2Load<Circle2>(Prim2ViewSoa(soa, 3, 2), 1);
+	if (c.x != 2 || c.y != 4 || c.r != 6)
+		cout << "Failed Prim2ViewSoa load.\r\n";
+	Obb2 o = Prim2Load<Obb2>(views[PRIM2_OBB], 7);
+	if (o.cx != obbs[7].cx || o.orientY != obbs[7].orientY || o.halfH != obbs[7].halfH)
+		cout << "Failed Prim2ViewAos load.\r\n";
+
+	// Serial narrowphase must agree with calling the tests directly
+	Cd2NarrowScratch scratch;
+	std::vector<unsigned int> serial, parallel;
+	Cd2NarrowPhase(0, views, &pairs[0], pairs.size(), &serial, &scratch);
+	std::vector<bool> hit(pairs.size(), false);
+	for (size_t i = 0; i < serial.size(); i++)
+		hit[serial[i]] = true;
+	for (size_t i = 0; i < pairs.size(); i++) {
+		if (Prim2RefType(pairs[i].a) != PRIM2_AABB || Prim2RefType(pairs[i].b) != PRIM2_OBB)
+			continue;
+		if (Cd2AO(aabbs[Prim2RefIndex(pairs[i].a)], obbs[Prim2RefIndex(pairs[i].b)]) != hit[i])
+			cout << "Failed Cd2NarrowPhase against Cd2AO for pair " << i << ".\r\n";
+	}
+	for (size_t i = 0; i < pairs.size(); i++) {
+		if (Prim2RefType(pairs[i].a) != PRIM2_TRIANGLE || Prim2RefType(pairs[i].b) != PRIM2_CIRCLE)
+			continue;
+		if (Cd2TC(tris[Prim2RefIndex(pairs[i].a)], circles[Prim2RefIndex(pairs[i].b)]) != hit[i])
+			cout << "Failed Cd2NarrowPhase against Cd2TC for pair " << i << ".\r\n";
+	}
+
+	// Threaded output must be identical, whatever the thread count or grain
+	for (int threads = 2; threads <= 8; threads *= 2) {
+		saw::JobPool pool;
+		if (!saw::JobPoolInit(&pool, threads))
+			cout << "Failed JobPoolInit with " << threads << " threads.\r\n";
+		for (int run = 0; run < 3; run++) {
+			Cd2NarrowPhase(&pool, views, &pairs[0], pairs.size(), &parallel, &scratch, 64 + run * 100);
+			if (parallel != serial)
+				cout << "Failed Cd2NarrowPhase determinism with " << threads << " threads.\r\n";
+		}
+		saw::JobPoolFree(&pool);
+	}
+
+	// Counters of the worker threads are merged too: one Cd2AA call per aabb pair
+	{
+		std::vector<Cd2Pair> boxPairs;
+		for (int i = 0; i < 100000; i++)
+			boxPairs.push_back(Cd2Pair(Prim2MakeRef(PRIM2_AABB, rand() % N), Prim2MakeRef(PRIM2_AABB, rand() % N)));
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, 4);
+		Cd2Stats stats;
+		Cd2StatsSnapshotAll(&stats, true);
+		Cd2NarrowPhase(&pool, views, &boxPairs[0], boxPairs.size(), &parallel, &scratch, 16);
+		saw::JobPoolFree(&pool);
+		Cd2StatsSnapshotAll(&stats, true);
+		if (stats.calls[CD2_STAT_AA] != boxPairs.size() || stats.hits[CD2_STAT_AA] != parallel.size())
+			cout << "Failed Cd2StatsSnapshotAll, " << stats.calls[CD2_STAT_AA] << " calls for " << boxPairs.size() << " pairs.\r\n";
+	}
+
+	// Back to back calls with few tasks, where workers still stealing from one call meet the next
+	{
+		saw::JobPool pool;
+		saw::JobPoolInit(&pool, 8);
+		for (int i = 0; i < 20000; i++) {
+			std::atomic<size_t> sum(0);
+			size_t n = 2 + i % 13;
+			saw::JobPoolFor(&pool, n, SumTask, &sum);
+			if (sum.load() != n * (n + 1) / 2) {
+				cout << "Failed JobPoolFor back to back at call " << i << ".\r\n";
+				break;
+			}
+		}
+		saw::JobPoolFree(&pool);
+	}
+
+	// World handles stay valid across swap-remove of other primitives
+	World2 world;
+	std::vector<World2Handle> handles;
+	for (int i = 0; i < N; i++) {
+		handles.push_back(World2Add(&world, aabbs[i]));
+		handles.push_back(World2Add(&world, circles[i]));
+	}
+	for (int i = 0; i < N; i += 3) {
+		if (!World2Remove(&world, handles[i * 2]))
+			cout << "Failed World2Remove of aabb " << i << ".\r\n";
+		if (World2Remove(&world, handles[i * 2]) || World2IsValid(&world, handles[i * 2]))
+			cout << "Failed World2Remove of stale handle " << i << ".\r\n";
+	}
+	if (World2GetCount(&world, PRIM2_AABB) != N - (N + 2) / 3 || World2GetCount(&world, PRIM2_CIRCLE) != N)
+		cout << "Failed World2GetCount after remove.\r\n";
+	for (int i = 0; i < N; i++) {
+		Aabb2 a;
+		Circle2 c;
+		bool removed = i % 3 == 0;
+		if (World2Get(&world, handles[i * 2], &a) == removed || (!removed && a != aabbs[i]))
+			cout << "Failed World2Get of aabb " << i << ".\r\n";
+		if (!World2Get(&world, handles[i * 2 + 1], &c) || c.x != circles[i].x || c.r != circles[i].r)
+			cout << "Failed World2Get of circle " << i << ".\r\n";
+		if (World2Get(&world, handles[i * 2 + 1], &a))
+			cout << "Failed World2Get with wrong type " << i << ".\r\n";
+		if (!removed && World2RefToHandle(&world, World2GetRef(&world, handles[i * 2])) != handles[i * 2])
+			cout << "Failed World2RefToHandle " << i << ".\r\n";
+	}
+
+	// Freed slots are reused with a new generation
+	World2Handle reused = World2Add(&world, obbs[0]);
+	if (World2HandleSlot(reused) != World2HandleSlot(handles[(N - 1) / 3 * 3 * 2]) || reused == handles[(N - 1) / 3 * 3 * 2])
+		cout << "Failed World2Add slot reuse.\r\n";
+	if (!World2Set(&world, reused, obbs[1]) || World2Set(&world, reused, aabbs[1]))
+		cout << "Failed World2Set.\r\n";
+
+	// Dispatch through handles matches the direct tests
+	for (int i = 1; i < N; i += 3) {
+		for (int j = 0; j < N; j += 7) {
+			if (World2Test(&world, handles[i * 2], handles[j * 2 + 1]) != Cd2AC(aabbs[i], circles[j]))
+				cout << "Failed World2Test aabb " << i << " circle " << j << ".\r\n";
+			if (World2Test(&world, handles[j * 2 + 1], reused) != Cd2CO(circles[j], obbs[1]))
+				cout << "Failed World2Test circle " << j << " obb.\r\n";
+		}
+	}
+
+	// Contact cache events must match a diff of consecutive frames
+	Contact2Cache cache;
+	std::set<unsigned long long> prev;
+	for (int frame = 0; frame < 50; frame++) {
+		std::set<unsigned long long> curr;
+		Contact2CacheBegin(&cache);
+		for (int i = 0; i < 400; i++) {
+			World2Handle a = 1 + rand() % 60, b = 1 + rand() % 60;
+			if (a == b)
+				continue;
+			curr.insert(Contact2Key(a, b));
+			Contact2CacheTouch(&cache, a, b);
+			if (i % 5 == 0)
+				Contact2CacheTouch(&cache, b, a);  // Duplicates are ignored
+		}
+		Contact2CacheEnd(&cache);
+		size_t begins = 0, stays = 0, ends = 0;
+		for (std::set<unsigned long long>::iterator it = curr.begin(); it != curr.end(); ++it)
+			(prev.count(*it) ? stays : begins)++;
+		for (std::set<unsigned long long>::iterator it = prev.begin(); it != prev.end(); ++it)
+			ends += curr.count(*it) ? 0 : 1;
+		if (cache.begins.size() != begins || cache.stays.size() != stays || cache.ends.size() != ends)
+			cout << "Failed Contact2Cache event counts in frame " << frame << ".\r\n";
+		for (size_t i = 0; i < cache.begins.size(); i++)
+			if (!curr.count(Contact2Key(cache.begins[i].a, cache.begins[i].b)) || prev.count(Contact2Key(cache.begins[i].a, cache.begins[i].b)) || cache.begins[i].a >= cache.begins[i].b)
+				cout << "Failed Contact2Cache begin event in frame " << frame << ".\r\n";
+		for (size_t i = 0; i < cache.ends.size(); i++)
+			if (curr.count(Contact2Key(cache.ends[i].a, cache.ends[i].b)) || !prev.count(Contact2Key(cache.ends[i].a, cache.ends[i].b)))
+				cout << "Failed Contact2Cache end event in frame " << frame << ".\r\n";
+		if (Contact2CacheGetCount(&cache) != curr.size())
+			cout << "Failed Contact2CacheGetCount in frame " << frame << ".\r\n";
+		prev.swap(curr);
+	}
+
+	// Contact cache straight from narrowphase output
+	std::vector<Cd2Pair> worldPairs;
+	for (int i = 1; i < N; i += 3)
+		for (int j = 0; j < N; j++)
+			worldPairs.push_back(Cd2Pair(World2GetRef(&world, handles[i * 2]), World2GetRef(&world, handles[j * 2 + 1])));
+	Prim2View worldViews[PRIM2_COUNT];
+	World2GetViews(&world, worldViews);
+	std::vector<unsigned int> worldHits;
+	Cd2NarrowPhase(0, worldViews, &worldPairs[0], worldPairs.size(), &worldHits, &scratch);
+	Contact2Cache worldCache;
+	Contact2CacheUpdate(&worldCache, &world, &worldPairs[0], &worldHits[0], worldHits.size());
+	if (worldHits.empty() || worldCache.begins.size() != worldHits.size() || !worldCache.stays.empty())
+		cout << "Failed Contact2CacheUpdate first frame.\r\n";
+	Contact2CacheUpdate(&worldCache, &world, &worldPairs[0], &worldHits[0], worldHits.size() / 2);
+	if (!worldCache.begins.empty() || worldCache.stays.size() != worldHits.size() / 2 || worldCache.ends.size() != worldHits.size() - worldHits.size() / 2)
+		cout << "Failed Contact2CacheUpdate second frame.\r\n";
+
+	// Broadphase must find exactly the overlapping pairs that pass the filter
+	for (int i = 0; i < N; i++)
+		World2SetFilter(&world, handles[i * 2 + 1], 1u << (i % 3), i % 4 ? 0xffffffffu : 0x6u);
+	World2PairScratch pairScratch;
+	std::vector<Cd2Pair> found;
+	World2FindPairs(&world, &found, &pairScratch);
+	std::set<unsigned long long> foundKeys;
+	for (size_t i = 0; i < found.size(); i++)
+		foundKeys.insert(Contact2Key(World2RefToHandle(&world, found[i].a), World2RefToHandle(&world, found[i].b)));
+	if (foundKeys.size() != found.size())
+		cout << "Failed World2FindPairs duplicate pairs.\r\n";
+	std::vector<World2Handle> all;
+	for (size_t i = 0; i < handles.size(); i++)
+		if (World2IsValid(&world, handles[i]))
+			all.push_back(handles[i]);
+	all.push_back(reused);
+	size_t expected = 0;
+	for (size_t i = 0; i < all.size(); i++) {
+		for (size_t j = i + 1; j < all.size(); j++) {
+			Aabb2 a(0, 0, 0, 0), b(0, 0, 0, 0);
+			unsigned int ca = 0, ma = 0, cb = 0, mb = 0;
+			World2GetBounds(&world, all[i], &a);
+			World2GetBounds(&world, all[j], &b);
+			World2GetFilter(&world, all[i], &ca, &ma);
+			World2GetFilter(&world, all[j], &cb, &mb);
+			if (!Cd2AA(a, b) || !World2CanPair(ca, ma, cb, mb))
+				continue;
+			expected++;
+			if (!foundKeys.count(Contact2Key(all[i], all[j])))
+				cout << "Failed World2FindPairs missing pair.\r\n";
+		}
+	}
+	if (expected != found.size() || expected == 0)
+		cout << "Failed World2FindPairs pair count.\r\n";
+
+	// Query must find exactly the overlapping primitives that pass the filter
+	std::vector<World2Handle> queried;
+	Aabb2 view(20, 30, 60, 55);
+	World2QueryAabb(&world, view, 0x2, 0xffffffff, &queried);
+	std::set<World2Handle> queriedSet(queried.begin(), queried.end());
+	size_t expectedQueried = 0;
+	for (size_t i = 0; i < all.size(); i++) {
+		Aabb2 a(0, 0, 0, 0);
+		unsigned int ca = 0, ma = 0;
+		World2GetBounds(&world, all[i], &a);
+		World2GetFilter(&world, all[i], &ca, &ma);
+		if (Cd2AA(a, view) && World2CanPair(0x2, 0xffffffff, ca, ma)) {
+			expectedQueried++;
+			if (!queriedSet.count(all[i]))
+				cout << "Failed World2QueryAabb missing handle.\r\n";
+		}
+	}
+	if (expectedQueried != queried.size() || expectedQueried == 0)
+		cout << "Failed World2QueryAabb count.\r\n";
+
+	// Morton sorting keeps handles pointing at the same primitives and returns the permutation
+	World2SortScratch sortScratch;
+	std::vector<unsigned int> perm;
+	std::vector<Prim2Ref> refsBefore(N);
+	for (int i = 0; i < N; i++)
+		refsBefore[i] = World2GetRef(&world, handles[i * 2 + 1]);
+	World2SortMorton(&world, 0, PRIM2_CIRCLE, &sortScratch, &perm);
+	if (perm.size() != World2GetCount(&world, PRIM2_CIRCLE))
+		cout << "Failed World2SortMorton permutation size.\r\n";
+	for (int i = 0; i < N; i++) {
+		Circle2 c;
+		if (!World2Get(&world, handles[i * 2 + 1], &c) || c.x != circles[i].x || c.y != circles[i].y || c.r != circles[i].r)
+			cout << "Failed World2SortMorton circle " << i << ".\r\n";
+		if (perm[Prim2RefIndex(World2GetRef(&world, handles[i * 2 + 1]))] != Prim2RefIndex(refsBefore[i]))
+			cout << "Failed World2SortMorton permutation " << i << ".\r\n";
+	}
+	size_t pairsBefore = found.size();
+	World2FindPairs(&world, &found, &pairScratch);
+	if (found.size() != pairsBefore)
+		cout << "Failed World2FindPairs after World2SortMorton.\r\n";
+
+	// Snapshots: a pinned epoch is never overwritten
+	{
+		World2 moving;
+		std::vector<World2Handle> boxes;
+		for (int i = 0; i < 200; i++)
+			boxes.push_back(World2Add(&moving, Aabb2(i * 2.0f, 0, i * 2.0f + 1, 1)));
+		World2Snapshots snaps;
+		if (World2SnapshotPin(&snaps))
+			cout << "Failed World2SnapshotPin before publish.\r\n";
+		World2Publish(&snaps, &moving, 0);
+		const World2Snapshot *first = World2SnapshotPin(&snaps);
+		for (int tick = 1; tick <= 5; tick++) {
+			for (int i = 0; i < 200; i++)
+				World2Set(&moving, boxes[i], Aabb2(i * 2.0f + tick, 0, i * 2.0f + 1 + tick, 1));
+			World2Publish(&snaps, &moving, 0);
+		}
+		Aabb2 a(0, 0, 0, 0);
+		if (!first || World2SnapshotGetEpoch(first) != 1 || !World2SnapshotGetBounds(first, boxes[10], &a) || a.minX != 20)
+			cout << "Failed World2Snapshot pinned epoch changed.\r\n";
+		World2SnapshotUnpin(first);
+		const World2Snapshot *last = World2SnapshotPin(&snaps);
+		if (World2SnapshotGetEpoch(last) != 6 || !World2SnapshotGetBounds(last, boxes[10], &a) || a.minX != 25)
+			cout << "Failed World2Snapshot current epoch.\r\n";
+		std::vector<World2Handle> hits;
+		std::vector<unsigned int> queryScratch;
+		World2SnapshotQueryAabb(last, Aabb2(5.5f, 0, 9.5f, 1), 1, 0xffffffff, &hits, &queryScratch);
+		if (hits.size() != 3)  // Boxes 0..2 at [5,6], [7,8], [9,10]
+			cout << "Failed World2SnapshotQueryAabb.\r\n";
+		World2SnapshotUnpin(last);
+
+		// Readers on other threads always see a consistent epoch while the writer moves everything
+		std::atomic<bool> done(false);
+		std::atomic<int> failures(0), reads(0);
+		std::vector<std::thread> readers;
+		for (int r = 0; r < 3; r++) {
+			readers.push_back(std::thread([&]() {
+				std::vector<World2Handle> found;
+				std::vector<unsigned int> scratch;
+				while (!done.load() || reads.load() < 100) {
+					const World2Snapshot *snap = World2SnapshotPin(&snaps);
+					float offset = static_cast<float>(World2SnapshotGetEpoch(snap) - 1);
+					for (int i = 0; i < 200; i += 13) {
+						Aabb2 b(0, 0, 0, 0);
+						if (!World2SnapshotGetBounds(snap, boxes[i], &b) || b.minX != i * 2.0f + offset)
+							failures++;
+					}
+					World2SnapshotQueryAabb(snap, Aabb2(offset + 100.5f, 0, offset + 120.5f, 1), 1, 0xffffffff, &found, &scratch);
+					if (found.size() != 11)  // Boxes 50..60
+						failures++;
+					World2SnapshotUnpin(snap);
+					reads++;
+				}
+			}));
+		}
+		for (int tick = 6; tick <= 200; tick++) {
+			for (int i = 0; i < 200; i++)
+				World2Set(&moving, boxes[i], Aabb2(i * 2.0f + tick, 0, i * 2.0f + 1 + tick, 1));
+			World2Publish(&snaps, &moving, 0);
+		}
+		done.store(true);
+		for (size_t r = 0; r < readers.size(); r++)
+			readers[r].join();
+		if (failures.load())
+			cout << "Failed World2Snapshot concurrent reads: " << failures.load() << ".\r\n";
+	}
+
+	// View queries: members always match a full query, and entered/exited are exactly the difference
+	{
+		World2 scene;
+		std::vector<World2Handle> all;
+		for (int i = 0; i < 3000; i++) {
+			float x = RandF(0, 200), y = RandF(0, 200);
+			all.push_back(World2Add(&scene, Aabb2(x, y, x + RandF(0, 4), y + RandF(0, 4))));
+			World2SetFilter(&scene, all.back(), 1u << (i % 2), 0xffffffff);
+		}
+		World2Snapshots snaps;
+		World2Publish(&snaps, &scene, 0);
+		World2View view;
+		std::set<World2Handle> before;
+		std::vector<World2Handle> expected;
+		std::vector<unsigned int> queryScratch;
+		float x = 50, y = 50;
+		for (int step = 0; step < 300; step++) {
+			if (step == 100 || step == 200) {  // Move and remove some primitives under the view
+				for (int i = 0; i < 3000; i += 7) {
+					float nx = x + RandF(-30, 60), ny = y + RandF(-30, 60);
+					World2Set(&scene, all[i], Aabb2(nx, ny, nx + 2, ny + 2));
+				}
+				for (int i = 3; i < 3000; i += 50)
+					World2Remove(&scene, all[i]);
+				World2Publish(&snaps, &scene, 0);
+			}
+			unsigned int category = step < 250 ? 1 : 2;
+			x += step % 40 == 39 ? RandF(-100, 100) : RandF(-2, 2);  // Sometimes jump
+			y += RandF(-2, 2);
+			Aabb2 box(x, y, x + RandF(29, 31), y + RandF(19, 21));
+			const World2Snapshot *snap = World2SnapshotPin(&snaps);
+			World2ViewUpdate(&view, snap, box, category, 0xffffffff);
+			World2SnapshotQueryAabb(snap, box, category, 0xffffffff, &expected, &queryScratch);
+			World2SnapshotUnpin(snap);
+			std::set<World2Handle> now(view.handles.begin(), view.handles.end());
+			std::set<World2Handle> expectedSet(expected.begin(), expected.end());
+			bool valid = now == expectedSet && now.size() == view.handles.size();
+			for (size_t i = 0; i < view.entered.size(); i++)
+				valid = valid && now.count(view.entered[i]) && !before.count(view.entered[i]);
+			for (size_t i = 0; i < view.exited.size(); i++)
+				valid = valid && !now.count(view.exited[i]) && before.count(view.exited[i]);
+			if (!valid || before.size() + view.entered.size() - view.exited.size() != now.size()) {
+				cout << "Failed World2ViewUpdate at step " << step << ".\r\n";
+				break;
+			}
+			before.swap(now);
+		}
+		World2ViewClear(&view);
+		if (!view.handles.empty())
+			cout << "Failed World2ViewClear.\r\n";
+	}
+
+	// Rollback restores exactly the saved frames, and resimulating from one gives the same frames again
+	{
+		RollbackSim sim;
+		for (int i = 0; i < 3000; i++) {
+			float x = RandF(0, 100), y = RandF(0, 100);
+			if (i % 2)
+				sim.handles.push_back(World2Add(&sim.world, Aabb2(x, y, x + RandF(0, 3), y + RandF(0, 3))));
+			else
+				sim.handles.push_back(World2Add(&sim.world, Triangle2(x, y, x + 1, y, x, y + RandF(.5f, 2))));
+		}
+		World2Rollback rb;
+		std::vector<std::vector<unsigned char> > recorded;
+		size_t dirty = 0;
+		for (unsigned int frame = 0; frame < 20; frame++) {
+			RollbackStep(&sim, frame);
+			World2RollbackSave(&rb, frame, &sim.world, &sim.cache, &sim.bvh);
+			recorded.push_back(PackState(&sim.world, &sim.cache, &sim.bvh));
+			if (frame)
+				dirty += rb.lastPages;
+		}
+		size_t pages = (recorded.back().size() + WORLD2_PAGE_SIZE - 1) / WORLD2_PAGE_SIZE;
+		if (World2RollbackHas(&rb, 10) || !World2RollbackHas(&rb, 11) || !World2RollbackHas(&rb, 19) ||
+			World2RollbackRestore(&rb, 10, &sim.world, &sim.cache, &sim.bvh) || dirty >= pages * 19)
+			cout << "Failed World2RollbackSave window, " << dirty << " pages of " << pages * 19 << ".\r\n";
+
+		const unsigned int restores[] = { 19, 14, 11, 16 };
+		for (int r = 0; r < 4; r++) {
+			unsigned int frame = restores[r];
+			if (!World2RollbackRestore(&rb, frame, &sim.world, &sim.cache, &sim.bvh))
+				cout << "Failed World2RollbackRestore of frame " << frame << ".\r\n";
+			if (PackState(&sim.world, &sim.cache, &sim.bvh) != recorded[frame])
+				cout << "Failed World2RollbackRestore state of frame " << frame << ".\r\n";
+			if (World2RollbackHas(&rb, frame + 1))
+				cout << "Failed World2RollbackRestore forgetting frames after " << frame << ".\r\n";
+			sim.handles.resize(3000 + (frame / 3 + 1));  // Handles added up to frame
+			for (unsigned int f = frame + 1; f < 20; f++) {
+				RollbackStep(&sim, f);
+				World2RollbackSave(&rb, f, &sim.world, &sim.cache, &sim.bvh);
+				if (PackState(&sim.world, &sim.cache, &sim.bvh) != recorded[f]) {
+					cout << "Failed resimulation of frame " << f << " after restoring " << frame << ".\r\n";
+					break;
+				}
+			}
+		}
+		World2RollbackClear(&rb);
+		if (World2RollbackHas(&rb, 19) || World2RollbackRestore(&rb, 19, &sim.world, &sim.cache, &sim.bvh))
+			cout << "Failed World2RollbackClear.\r\n";
+
+		// Adding and removing primitives copies a few pages, not the arrays after them
+		World2 big;
+		std::vector<World2Handle> bigHandles;
+		for (int i = 0; i < 100000; i++) {
+			float x = RandF(0, 1000), y = RandF(0, 1000);
+			bigHandles.push_back(World2Add(&big, Aabb2(x, y, x + 1, y + 1)));
+		}
+		World2Rollback bigRb;
+		World2RollbackSave(&bigRb, 0, &big, (Contact2Cache *)0, (Bvh2<4> *)0);
+		std::vector<unsigned char> state0 = PackState(&big, 0, (Bvh2<4> *)0);
+		World2RollbackSave(&bigRb, 1, &big, (Contact2Cache *)0, (Bvh2<4> *)0);
+		size_t unchanged = bigRb.lastPages;
+		World2Add(&big, Point2(5, 5));
+		World2RollbackSave(&bigRb, 2, &big, (Contact2Cache *)0, (Bvh2<4> *)0);
+		size_t added = bigRb.lastPages;
+		World2Remove(&big, bigHandles[500]);
+		World2RollbackSave(&bigRb, 3, &big, (Contact2Cache *)0, (Bvh2<4> *)0);
+		size_t removed = bigRb.lastPages;
+		if (unchanged != 0 || added > 12 || removed > 26)
+			cout << "Failed World2RollbackSave pages: " << unchanged << ", " << added << ", " << removed << ".\r\n";
+		if (!World2RollbackRestore(&bigRb, 0, &big, (Contact2Cache *)0, (Bvh2<4> *)0) ||
+			PackState(&big, 0, (Bvh2<4> *)0) != state0)
+			cout << "Failed World2RollbackRestore after adding and removing.\r\n";
+	}
+
+	// Every stage above left timing probes, the narrowphase tasks on the worker threads too
+	{
+		std::vector<saw::ProfSpan> spans;
+		saw::ProfCollect(&spans);
+		const char *stages[] = { "Cd2NarrowPhase", "Cd2NarrowTask", "World2SortMorton", "World2FindPairs",
+			"Contact2CacheUpdate", "World2Publish", "World2ViewUpdate", "World2RollbackSave", "World2RollbackRestore" };
+		for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+			bool found = false;
+			for (size_t j = 0; j < spans.size() && !found; j++)
+				found = !strcmp(spans[j].name, stages[i]);
+			if (!found)
+				cout << "Failed ProfCollect of " << stages[i] << ".\r\n";
+		}
+		int threads = 0;
+		for (size_t j = 0; j < spans.size(); j++) {
+			if (spans[j].duration < 0 || (j > 0 && spans[j].start < spans[j - 1].start))
+				cout << "Failed ProfCollect order at " << j << ".\r\n";
+			threads = spans[j].thread + 1 > threads ? spans[j].thread + 1 : threads;
+		}
+		if (threads < 2)
+			cout << "Failed ProfCollect of worker threads.\r\n";
+		std::string trace;
+		saw::Io io = { &trace, 0, WriteString, 0, 0, 0 };
+		if (!saw::ProfWriteChromeTrace(&io) || trace.compare(0, 16, "{\"traceEvents\":[") != 0 ||
+			trace.find("\"name\":\"World2FindPairs\",\"ph\":\"X\"") == std::string::npos)
+			cout << "Failed ProfWriteChromeTrace.\r\n";
+		saw::ProfClear();
+		saw::ProfCollect(&spans);
+		if (!spans.empty())
+			cout << "Failed ProfClear.\r\n";
+	}
+
+	// Collecting while a thread records wrapping its buffer returns only whole events. Durations are 1, 2 or 3
+	// units, matching the name, so an event torn between two writes shows as a wrong duration.
+	{
+		const char *names[] = { "ProfOne", "ProfTwo", "ProfThree" };
+		std::atomic<unsigned long long> recorded(0);
+		std::atomic<bool> stop(false);
+		std::thread recorder([&]() {
+			for (unsigned long long i = 0; !stop.load(); i++) {
+				saw::ProfRecord(names[i % 3], i * 64, i * 64 + (i % 3 + 1) * 1000);
+				recorded.store(i + 1);
+			}
+		});
+		while (recorded.load() < 2 * SAW_PROF_CAPACITY)
+			std::this_thread::yield();
+		std::vector<saw::ProfSpan> spans;
+		size_t bad = 0, seen = 0;
+		for (int pass = 0; pass < 50; pass++) {
+			saw::ProfCollect(&spans);
+			double unit = 0;  // Ticks per microsecond are calibrated again by each collect
+			for (size_t j = 0; j < spans.size(); j++) {
+				int k = 0;
+				while (k < 3 && strcmp(spans[j].name, names[k]))
+					k++;
+				if (k == 3)
+					continue;
+				double u = spans[j].duration / (k + 1);
+				if (!unit)
+					unit = u;
+				bad += fabs(u - unit) > unit * 1e-6;
+				seen++;
+			}
+		}
+		stop.store(true);
+		recorder.join();
+		if (bad || seen < 50)
+			cout << "Failed ProfCollect while recording, " << bad << " torn of " << seen << ".\r\n";
+		saw::ProfClear();
+	}
+
+	return 0;
+}